@@ -0,0 +1,131 @@
+#include "allocation_tracker.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace allocation_tracker {
+
+namespace {
+
+std::array<std::atomic<U64>, static_cast<int>(Phase::kNumPhases)> allocation_counts{};
+thread_local Phase current_phase = Phase::kOther;
+
+}  // namespace
+
+void count_allocation() {
+  allocation_counts[static_cast<int>(current_phase)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void set_phase_internal(Phase phase) {
+  current_phase = phase;
+}
+
+U64 allocations(Phase phase) {
+  return allocation_counts[static_cast<int>(phase)].load(std::memory_order_relaxed);
+}
+
+void reset() {
+  for (auto &count : allocation_counts) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+}
+
+#ifdef ALLOCATION_TRACKING
+
+// every replaceable allocation function ends up here, so nothing slips past the counter
+// plain malloc calls aren't hooked, since nothing in the engine calls it directly
+namespace {
+
+void *tracked_allocate(std::size_t size, std::size_t alignment = 0) {
+  allocation_tracker::count_allocation();
+
+  if (size == 0) {
+    size = 1;
+  }
+
+  void *pointer;
+  if (alignment > alignof(std::max_align_t)) {
+    // aligned_alloc requires the size to be a multiple of the alignment
+    pointer = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+  } else {
+    pointer = std::malloc(size);
+  }
+
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+  return tracked_allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+  return tracked_allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return tracked_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return tracked_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return tracked_allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return tracked_allocate(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+#endif
\ No newline at end of file
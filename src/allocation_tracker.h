@@ -0,0 +1,41 @@
+#ifndef INTEGRAL_ALLOCATION_TRACKER_H_
+#define INTEGRAL_ALLOCATION_TRACKER_H_
+
+#include "types.h"
+
+// counts heap allocations made through the global operator new, split by what the allocating thread was doing
+// only compiled in when ALLOCATION_TRACKING is defined (cmake -DALLOCATION_TRACKING=ON), the search hot path is
+// expected to never allocate, so any allocation in Phase::kSearch is a bug
+namespace allocation_tracker {
+
+#ifdef ALLOCATION_TRACKING
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+enum class Phase : U8 {
+  kOther,
+  kSearch,
+  kOutput,
+  kNumPhases
+};
+
+void set_phase_internal(Phase phase);
+
+void count_allocation();
+
+// marks what the calling thread is doing from now on, allocations on other threads are counted as kOther
+inline void set_phase(Phase phase) {
+  if constexpr (kEnabled) {
+    set_phase_internal(phase);
+  }
+}
+
+[[nodiscard]] U64 allocations(Phase phase);
+
+void reset();
+
+}
+
+#endif // INTEGRAL_ALLOCATION_TRACKER_H_
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "attack_info.h"
+#include "move_gen.h"
+
+BitBoard AttackInfo::threats_by_lesser(const BoardState &state, PieceType piece) {
+  const auto &attacks = get(state, flip_color(state.turn));
+  switch (piece) {
+    case PieceType::kKnight:
+    case PieceType::kBishop:
+      return attacks.pawns;
+    case PieceType::kRook:
+      return attacks.pawns | attacks.minors;
+    case PieceType::kQueen:
+      return attacks.pawns | attacks.minors | attacks.rooks;
+    default:
+      return 0;
+  }
+}
+
+void AttackInfo::compute(const BoardState &state, Color side) {
+  auto &attacks = attacks_[side];
+  const BitBoard occupied = state.occupied() ^ state.king(flip_color(side));
+
+  const BitBoard pawns = state.pawns(side);
+  attacks.pawns = side == Color::kWhite
+                      ? shift<Direction::kNorthEast>(pawns) | shift<Direction::kNorthWest>(pawns)
+                      : shift<Direction::kSouthEast>(pawns) | shift<Direction::kSouthWest>(pawns);
+
+  attacks.minors = 0;
+
+  BitBoard knights = state.knights(side);
+  while (knights) {
+    attacks.minors |= move_gen::knight_moves(Square(knights.pop_lsb()));
+  }
+
+  BitBoard bishops = state.bishops(side);
+  while (bishops) {
+    attacks.minors |= move_gen::bishop_moves(Square(bishops.pop_lsb()), occupied);
+  }
+
+  attacks.rooks = 0;
+
+  BitBoard rooks = state.rooks(side);
+  while (rooks) {
+    attacks.rooks |= move_gen::rook_moves(Square(rooks.pop_lsb()), occupied);
+  }
+
+  BitBoard queen_attacks = 0;
+
+  BitBoard queens = state.queens(side);
+  while (queens) {
+    const auto square = Square(queens.pop_lsb());
+    queen_attacks |= move_gen::bishop_moves(square, occupied) | move_gen::rook_moves(square, occupied);
+  }
+
+  attacks.all = attacks.pawns | attacks.minors | attacks.rooks | queen_attacks |
+                move_gen::king_attacks(Square(state.king(side).get_lsb_pos()));
+
+  computed_[side] = true;
+}
@@ -0,0 +1,53 @@
+#ifndef INTEGRAL_ATTACK_INFO_H_
+#define INTEGRAL_ATTACK_INFO_H_
+
+#include "bitboard.h"
+
+class BoardState;
+
+// the squares each side attacks in a position, computed at most once per side and only when first needed
+// sliders see through the other side's king, so a square the king steps to along a checking ray counts as attacked
+class AttackInfo {
+ public:
+  AttackInfo() : computed_({false, false}) {}
+
+  // must be called when the position changes
+  inline void reset() {
+    computed_ = {false, false};
+  }
+
+  // all squares attacked by the side
+  [[nodiscard]] inline const BitBoard &attacked(const BoardState &state, Color side) {
+    return get(state, side).all;
+  }
+
+  [[nodiscard]] inline const BitBoard &pawn_attacks(const BoardState &state, Color side) {
+    return get(state, side).pawns;
+  }
+
+  // squares where a piece of the side to move would be attacked by an enemy piece worth less than it
+  [[nodiscard]] BitBoard threats_by_lesser(const BoardState &state, PieceType piece);
+
+ private:
+  struct Attacks {
+    BitBoard all;
+    BitBoard pawns;
+    BitBoard minors;
+    BitBoard rooks;
+  };
+
+  inline const Attacks &get(const BoardState &state, Color side) {
+    if (!computed_[side]) {
+      compute(state, side);
+    }
+    return attacks_[side];
+  }
+
+  void compute(const BoardState &state, Color side);
+
+ private:
+  std::array<Attacks, 2> attacks_;
+  std::array<bool, 2> computed_;
+};
+
+#endif // INTEGRAL_ATTACK_INFO_H_
@@ -0,0 +1,136 @@
+#include "bitbase.h"
+#include "move_gen.h"
+
+namespace bitbase {
+
+namespace {
+
+// white king square, black king square, side to move, and the pawn's file (a-d) and rank (2-7)
+constexpr int kNumPositions = 64 * 64 * 2 * 4 * 6;
+
+// a position's result is a bitmask, so the results of its successors can be or-ed together
+enum Result : U8 {
+  kInvalid = 0,
+  kUnknown = 1,
+  kDraw = 2,
+  kWin = 4
+};
+
+std::array<U32, kNumPositions / 32> kpk_wins;
+
+int index(Color turn, Square black_king, Square white_king, Square pawn) {
+  return white_king | (black_king << 6) | (turn << 12) | (file(pawn) << 13) | ((rank(pawn) - 1) << 15);
+}
+
+int distance(Square first, Square second) {
+  return std::max(std::abs(file(first) - file(second)), std::abs(rank(first) - rank(second)));
+}
+
+BitBoard white_pawn_attacks(Square pawn) {
+  const BitBoard pawn_bb = BitBoard::from_square(pawn);
+  return shift<Direction::kNorthEast>(pawn_bb) | shift<Direction::kNorthWest>(pawn_bb);
+}
+
+struct Position {
+  Position() = default;
+
+  explicit Position(int idx) {
+    white_king = Square(idx & 63);
+    black_king = Square((idx >> 6) & 63);
+    turn = Color((idx >> 12) & 1);
+    pawn = rank_file_to_square(((idx >> 15) & 7) + 1, (idx >> 13) & 3);
+
+    if (distance(white_king, black_king) <= 1 || white_king == pawn || black_king == pawn ||
+        // the side not to move can't be in check
+        (turn == Color::kWhite && white_pawn_attacks(pawn).is_set(black_king))) {
+      result = kInvalid;
+    } else if (turn == Color::kWhite && rank(pawn) == 6 && white_king != pawn + 8 && black_king != pawn + 8 &&
+               (distance(black_king, Square(pawn + 8)) > 1 || distance(white_king, Square(pawn + 8)) == 1)) {
+      // the pawn promotes and the queen can't be captured
+      result = kWin;
+    } else if (turn == Color::kBlack &&
+               (!(move_gen::king_attacks(black_king) &
+                  ~(move_gen::king_attacks(white_king) | white_pawn_attacks(pawn))) ||
+                (distance(black_king, pawn) == 1 && distance(white_king, pawn) > 1))) {
+      // stalemate, or the undefended pawn is captured
+      result = kDraw;
+    } else {
+      result = kUnknown;
+    }
+  }
+
+  Result classify(const std::vector<Position> &positions) const {
+    // white wins if any move wins, black draws if any move draws
+    const Result good = turn == Color::kWhite ? kWin : kDraw;
+    const Result bad = turn == Color::kWhite ? kDraw : kWin;
+
+    const Square our_king = turn == Color::kWhite ? white_king : black_king;
+    const Color them = flip_color(turn);
+
+    int results = kInvalid;
+
+    BitBoard king_moves = move_gen::king_attacks(our_king);
+    while (king_moves) {
+      const auto to = Square(king_moves.pop_lsb());
+      results |= turn == Color::kWhite ? positions[index(them, black_king, to, pawn)].result
+                                       : positions[index(them, to, white_king, pawn)].result;
+    }
+
+    if (turn == Color::kWhite) {
+      if (rank(pawn) < 6) {
+        results |= positions[index(them, black_king, white_king, Square(pawn + 8))].result;
+      }
+
+      if (rank(pawn) == 1 && pawn + 8 != white_king && pawn + 8 != black_king) {
+        results |= positions[index(them, black_king, white_king, Square(pawn + 16))].result;
+      }
+    }
+
+    if (results & good) return good;
+    if (results & kUnknown) return kUnknown;
+    return bad;
+  }
+
+  Square white_king;
+  Square black_king;
+  Square pawn;
+  Color turn;
+  Result result;
+};
+
+}
+
+void init_kpk() {
+  std::vector<Position> positions;
+  positions.reserve(kNumPositions);
+
+  for (int idx = 0; idx < kNumPositions; idx++) {
+    positions.emplace_back(idx);
+  }
+
+  // keep resolving unknown positions from their successors until nothing changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &position : positions) {
+      if (position.result == kUnknown && (position.result = position.classify(positions)) != kUnknown) {
+        changed = true;
+      }
+    }
+  }
+
+  kpk_wins.fill(0);
+  for (int idx = 0; idx < kNumPositions; idx++) {
+    if (positions[idx].result == kWin) {
+      kpk_wins[idx / 32] |= 1U << (idx % 32);
+    }
+  }
+}
+
+bool probe_kpk(Square white_king, Square white_pawn, Square black_king, Color turn) {
+  assert(file(white_pawn) < 4);
+  const int idx = index(turn, black_king, white_king, white_pawn);
+  return kpk_wins[idx / 32] & (1U << (idx % 32));
+}
+
+}
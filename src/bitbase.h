@@ -0,0 +1,18 @@
+#ifndef INTEGRAL_BITBASE_H_
+#define INTEGRAL_BITBASE_H_
+
+#include "bitboard.h"
+
+// king and pawn versus king bitbase, generated at startup by retrograde analysis
+namespace bitbase {
+
+// must be called after the attack tables are initialized
+void init_kpk();
+
+// whether the side with the pawn wins, with the position given from white's point of view with the pawn on files a-d
+// (callers flip the board vertically when the pawn is black's, and horizontally when it's on files e-h)
+[[nodiscard]] bool probe_kpk(Square white_king, Square white_pawn, Square black_king, Color turn);
+
+}
+
+#endif // INTEGRAL_BITBASE_H_
@@ -1,11 +1,13 @@
 #include "board.h"
+#include "cuckoo.h"
 #include "fen.h"
 #include "move.h"
 #include "move_gen.h"
 
-Board::Board(std::size_t transpo_table_size) : transpo_table_(transpo_table_size), history_() {}
+Board::Board(std::size_t transpo_table_size)
+    : transpo_table_(transpo_table_size), history_(), accumulators_(kMaxGamePly + 1) {}
 
-Board::Board() : history_(), initialized_(false) {}
+Board::Board() : history_(), initialized_(false), accumulators_(kMaxGamePly + 1) {}
 
 void Board::set_from_fen(const std::string &fen_str) {
   // reset history everytime we parse from fen, since they will be re-applied when the moves are made
@@ -14,6 +16,14 @@ void Board::set_from_fen(const std::string &fen_str) {
   initialized_ = true;
 
   calculate_king_attacks();
+
+  refresh_accumulator();
+}
+
+void Board::refresh_accumulator() {
+  if (nnue::is_enabled()) {
+    nnue::refresh(state_, accumulators_[history_.size()]);
+  }
 }
 
 bool Board::is_move_pseudo_legal(const Move &move) {
@@ -62,6 +72,11 @@ bool Board::is_move_pseudo_legal(const Move &move) {
 }
 
 bool Board::is_move_legal(const Move &move) {
+  AttackInfo attack_info;
+  return is_move_legal(move, attack_info);
+}
+
+bool Board::is_move_legal(const Move &move, AttackInfo &attack_info) {
   const Color us = state_.turn, them = flip_color(us);
   const bool is_white = state_.turn == Color::kWhite;
 
@@ -73,7 +88,8 @@ bool Board::is_move_legal(const Move &move) {
 
   const auto piece_type = state_.get_piece_type(from);
   if (piece_type == PieceType::kKing) {
-    const BitBoard their_pieces = state_.occupied(them);
+    // the opponent's sliders see through our king, so moving along the ray the king is attacked on is caught too
+    const BitBoard &threats = attack_info.attacked(state_, them);
 
     const int kKingsideCastleDist = -2;
     const int kQueensideCastleDist = 2;
@@ -81,22 +97,15 @@ bool Board::is_move_legal(const Move &move) {
     // note: the only way move_dist is ever 2 or -2 is from move_gen::castling_moves allowing it
     const int move_dist = static_cast<int>(from) - static_cast<int>(to);
     if (move_dist == kKingsideCastleDist) {
-      return !move_gen::get_attackers_to(state_, is_white ? Square::kG1 : Square::kG8, them) &&
-             !move_gen::get_attackers_to(state_, is_white ? Square::kF1 : Square::kF8, them);
+      return !threats.is_set(is_white ? Square::kG1 : Square::kG8) &&
+             !threats.is_set(is_white ? Square::kF1 : Square::kF8);
     } else if (move_dist == kQueensideCastleDist) {
-      return !move_gen::get_attackers_to(state_, is_white ? Square::kC1 : Square::kC8, them) &&
-             !move_gen::get_attackers_to(state_, is_white ? Square::kD1 : Square::kD8, them);
+      return !threats.is_set(is_white ? Square::kC1 : Square::kC8) &&
+             !threats.is_set(is_white ? Square::kD1 : Square::kD8);
     }
 
-    const BitBoard occupied_kingless = state_.occupied() ^ state_.king(us);
-    const BitBoard their_queens = state_.queens(them);
-
     // make sure the destination square isn't attacked
-    // also, verify that the king isn't moving along the same ray it's being attacked on, since the threats bitboard
-    // doesn't xray past pieces
-    return !move_gen::get_attackers_to(state_, to, them) &&
-           !(move_gen::bishop_moves(to, occupied_kingless) & (their_queens | state_.bishops(them))) &&
-           !(move_gen::rook_moves(to, occupied_kingless) & (their_queens | state_.rooks(them)));
+    return !threats.is_set(to);
   } else if (piece_type == PieceType::kPawn && to == state_.en_passant) {
     // pawn must be directly behind/in front of the attack square
     const BitBoard en_passant_pawn_mask = BitBoard::from_square(is_white ? to - 8 : to + 8);
@@ -139,10 +148,23 @@ void Board::make_move(const Move &move) {
   // xor out the previous turn hash and moved piece
   state_.zobrist_key ^= zobrist::hash_square(from, state_, state_.turn, piece_type) ^ zobrist::hash_turn(state_.turn);
 
+  accumulator_delta_.clear();
+  accumulator_delta_.remove(state_.turn, piece_type, from);
+
+  // the pawn key only changes when a pawn moves, is captured or promotes
+  if (piece_type == PieceType::kPawn) {
+    state_.pawn_key ^= zobrist::hash_square(from, state_, state_.turn, PieceType::kPawn);
+  }
+
   const auto captured_piece = state_.get_piece_type(to);
   if (captured_piece != PieceType::kNone) {
     state_.zobrist_key ^= zobrist::hash_square(to, state_, flip_color(state_.turn), captured_piece);
     state_.remove_piece(to);
+    accumulator_delta_.remove(flip_color(state_.turn), captured_piece, to);
+
+    if (captured_piece == PieceType::kPawn) {
+      state_.pawn_key ^= zobrist::hash_square(to, state_, flip_color(state_.turn), PieceType::kPawn);
+    }
 
     // reset fifty moves clock since this move was a capture
     new_fifty_move_clock = 0;
@@ -163,6 +185,9 @@ void Board::make_move(const Move &move) {
       state_.zobrist_key ^=
           zobrist::hash_square(en_passant_pawn_pos, state_, flip_color(state_.turn), PieceType::kPawn);
       state_.remove_piece(en_passant_pawn_pos);
+      accumulator_delta_.remove(flip_color(state_.turn), PieceType::kPawn, en_passant_pawn_pos);
+      state_.pawn_key ^=
+          zobrist::hash_square(en_passant_pawn_pos, state_, flip_color(state_.turn), PieceType::kPawn);
 
       // xor out the en passant pos
       state_.zobrist_key ^= zobrist::hash_en_passant(state_);
@@ -210,8 +235,14 @@ void Board::make_move(const Move &move) {
   } else {
     // xor in the moved piece
     state_.zobrist_key ^= zobrist::hash_square(to, state_, state_.turn, piece_type);
+
+    if (piece_type == PieceType::kPawn) {
+      state_.pawn_key ^= zobrist::hash_square(to, state_, state_.turn, PieceType::kPawn);
+    }
   }
 
+  accumulator_delta_.add(state_.turn, state_.get_piece_type(to), to);
+
   // xor in new turn
   state_.turn = flip_color(state_.turn);
   state_.zobrist_key ^= zobrist::hash_turn(state_.turn);
@@ -223,9 +254,20 @@ void Board::make_move(const Move &move) {
   }
 
   state_.fifty_moves_clock = new_fifty_move_clock;
+  state_.plies_from_null++;
   state_.move_played = move;
 
   calculate_king_attacks();
+  update_accumulator();
+}
+
+void Board::update_accumulator() {
+  if (!nnue::is_enabled()) {
+    return;
+  }
+
+  const int ply = history_.size();
+  nnue::update(accumulators_[ply - 1], accumulators_[ply], accumulator_delta_);
 }
 
 void Board::undo_move() {
@@ -250,9 +292,14 @@ void Board::make_null_move() {
   state_.zobrist_key ^= zobrist::hash_turn(state_.turn);
 
   state_.fifty_moves_clock++;
+  state_.plies_from_null = 0;
   state_.move_played = Move::null_move();
 
   calculate_king_attacks();
+
+  // no pieces moved, so the accumulator stays the same
+  accumulator_delta_.clear();
+  update_accumulator();
 }
 
 U64 Board::key_after(const Move &move) {
@@ -304,42 +351,40 @@ bool Board::has_repeated(int ply) {
   return false;
 }
 
-bool Board::is_draw(int ply) {
-  if (state_.fifty_moves_clock >= 100 || has_repeated(ply)) {
-    return true;
-  }
-
-  // insufficient material detection
-  const Color us = state_.turn, them = flip_color(us);
+bool Board::has_upcoming_repetition(int ply) {
+  // a cycle through a null move isn't one that can be played
+  const int max_dist = std::min<int>(std::min(state_.fifty_moves_clock, state_.plies_from_null), history_.size());
+  const BitBoard occupied = state_.occupied();
+
+  // a position with the opponent to move an odd number of plies back, that differs from this one by a single
+  // reversible move, can be reached again by playing that move
+  for (int i = 3; i <= max_dist; i += 2) {
+    const Move move = cuckoo::find_move(state_.zobrist_key ^ history_[history_.size() - i].zobrist_key);
+    if (move.is_null()) {
+      continue;
+    }
 
-  // check for queens, rooks, or pawns on the board
-  if (state_.queens() || state_.rooks() || state_.pawns()) {
-    return false;
-  }
+    // the move is only playable if nothing stands between its squares
+    if (move_gen::ray_between(move.get_from(), move.get_to()) & occupied) {
+      continue;
+    }
 
-  if (!state_.kingless_occupied()) {
-    return true;
+    // cycles that go back past the root aren't a draw unless the game repeats them, so only ones inside the search count
+    if (ply > i) {
+      return true;
+    }
   }
 
-  const BitBoard our_knights = state_.knights(us), their_knights = state_.knights(them);
-  const BitBoard our_bishops = state_.bishops(us), their_bishops = state_.bishops(them);
-  
-  const BitBoard their_minor_pieces = their_knights | their_bishops;
-  const BitBoard our_minor_pieces = our_knights | our_bishops;
-
-  // more than one minor piece on either side
-  if (their_minor_pieces.more_than_one() || our_minor_pieces.more_than_one()) {
-    return false;
-  }
+  return false;
+}
 
-  // lone king on one side and one minor piece on the other
-  if (their_minor_pieces != 0 && state_.kingless_occupied(us) == 0 ||
-      our_minor_pieces != 0 && state_.kingless_occupied(them) == 0) {
+bool Board::is_draw(int ply) {
+  if (state_.fifty_moves_clock >= 100 || has_repeated(ply)) {
     return true;
   }
 
-  // any other combination of pieces not covered by the above is not a draw
-  return false;
+  // insufficient material only depends on the material signature
+  return material_table_.probe(state_.material_key).is_draw;
 }
 
 void Board::handle_castling(const Move &move) {
@@ -360,6 +405,9 @@ void Board::handle_castling(const Move &move) {
         state_.remove_piece(rook_from);
         state_.place_piece(rook_to, PieceType::kRook, state_.turn);
 
+        accumulator_delta_.remove(state_.turn, PieceType::kRook, rook_from);
+        accumulator_delta_.add(state_.turn, PieceType::kRook, rook_to);
+
         // xor in the rook's new square
         state_.zobrist_key ^= zobrist::hash_square(rook_to, state_, state_.turn, PieceType::kRook);
       };
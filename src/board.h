@@ -10,6 +10,12 @@
 #include "bitboard.h"
 #include "zobrist.h"
 #include "transpo.h"
+#include "psqt.h"
+#include "nnue.h"
+#include "pawn_table.h"
+#include "eval_cache.h"
+#include "material.h"
+#include "attack_info.h"
 
 const int kMaxPlyFromRoot = 256;
 const int kMaxGamePly = 1024;
@@ -80,25 +86,40 @@ class CastleRights {
 
 struct BoardState {
   BoardState()
-      : fifty_moves_clock(0),
+      : turn(Color::kWhite),
+        fifty_moves_clock(0),
+        plies_from_null(0),
+        en_passant(Square::kNoSquare),
         zobrist_key(0ULL),
-        turn(Color::kWhite),
+        pawn_key(0ULL),
+        material_key(0ULL),
+        move_played(Move::null_move()),
         checkers(0ULL),
         pinned(0ULL),
-        en_passant(Square::kNoSquare),
-        move_played(Move::null_move()) {
+        phase(0) {
     piece_on_square.fill(PieceType::kNone);
   }
 
+  // the piece-square score, game phase and material key are kept up to date here, so every piece added or removed by
+  // make_move(), castling and promotions is accounted for without evaluating the board from scratch
   void place_piece(const U8 &square, const PieceType &piece_type, const Color &color) {
     piece_on_square[square] = piece_type;
     piece_bbs[piece_type].set_bit(square);
     side_bbs[color].set_bit(square);
+
+    piece_square_score += eval::piece_square_table[color][piece_type][square];
+    phase += eval::kGamePhaseIncrements[piece_type];
+    material_key += eval::material_key_increment(color, piece_type);
   }
 
   void remove_piece(const U8 &square) {
     auto &piece_type = piece_on_square[square];
     if (piece_type != PieceType::kNone) {
+      const Color color = get_piece_color(square);
+      piece_square_score -= eval::piece_square_table[color][piece_type][square];
+      phase -= eval::kGamePhaseIncrements[piece_type];
+      material_key -= eval::material_key_increment(color, piece_type);
+
       piece_bbs[piece_type].clear_bit(square);
       side_bbs[Color::kBlack].clear_bit(square);
       side_bbs[Color::kWhite].clear_bit(square);
@@ -189,12 +210,18 @@ struct BoardState {
   std::array<PieceType, Square::kSquareCount> piece_on_square;
   Color turn;
   U16 fifty_moves_clock;
+  // plies played since the last null move (or the position was set up), no earlier position can be reached again
+  U16 plies_from_null;
   Square en_passant;
   CastleRights castle_rights;
   U64 zobrist_key;
+  U64 pawn_key;
+  U64 material_key;
   Move move_played;
   BitBoard checkers;
   BitBoard pinned;
+  eval::PackedScore piece_square_score;
+  int phase;
 };
 
 class Board {
@@ -215,6 +242,27 @@ class Board {
     return transpo_table_;
   }
 
+  inline eval::PawnTable &get_pawn_table() {
+    return pawn_table_;
+  }
+
+  inline eval::EvalCache &get_eval_cache() {
+    return eval_cache_;
+  }
+
+  inline eval::MaterialTable &get_material_table() {
+    return material_table_;
+  }
+
+  // the nnue accumulator of the current position, only kept up to date while the nnue is enabled
+  inline const nnue::Accumulator &get_accumulator() const {
+    return accumulators_[history_.size()];
+  }
+
+  // recomputes the accumulator of the current position, for when the network or whether it's used changed
+  // the accumulators of the earlier positions aren't, so the moves leading here can't be undone with the nnue
+  void refresh_accumulator();
+
   [[nodiscard]] bool initialized() const {
     return initialized_;
   }
@@ -226,6 +274,9 @@ class Board {
   // assuming the move is pseudo legal
   [[nodiscard]] bool is_move_legal(const Move &move);
 
+  // same as above, with the opponent's attacks taken from (and computed into) the attack info of this position
+  [[nodiscard]] bool is_move_legal(const Move &move, AttackInfo &attack_info);
+
   void make_move(const Move &move);
 
   void make_null_move();
@@ -236,6 +287,9 @@ class Board {
 
   [[nodiscard]] bool has_repeated(int ply);
 
+  // whether the side to move has a move that repeats a position from earlier in the search
+  [[nodiscard]] bool has_upcoming_repetition(int ply);
+
   [[nodiscard]] bool is_draw(int ply);
 
   void print_pieces();
@@ -247,11 +301,19 @@ class Board {
 
   void calculate_king_attacks();
 
+  void update_accumulator();
+
  private:
   BoardState state_;
   TranspositionTable transpo_table_;
+  eval::PawnTable pawn_table_;
+  eval::EvalCache eval_cache_;
+  eval::MaterialTable material_table_;
   bool initialized_;
   List<BoardState, kMaxGamePly> history_;
+  // one accumulator per history entry (plus the current position), so undoing a move is free
+  std::vector<nnue::Accumulator> accumulators_;
+  nnue::FeatureDelta accumulator_delta_;
 };
 
 #endif // INTEGRAL_BOARD_H_
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "cuckoo.h"
+#include "move_gen.h"
+#include "zobrist.h"
+
+namespace cuckoo {
+
+namespace {
+
+// the 3668 reversible moves of knights, bishops, rooks, queens and kings on an empty board fit comfortably
+constexpr int kTableSize = 8192;
+
+std::array<U64, kTableSize> keys;
+std::array<Move, kTableSize> moves;
+
+// the two slots a key can be stored in
+int first_index(U64 key) {
+  return static_cast<int>(key & (kTableSize - 1));
+}
+
+int second_index(U64 key) {
+  return static_cast<int>((key >> 16) & (kTableSize - 1));
+}
+
+BitBoard empty_board_attacks(PieceType piece, Square square) {
+  switch (piece) {
+    case PieceType::kKnight:
+      return move_gen::knight_moves(square);
+    case PieceType::kBishop:
+      return move_gen::bishop_moves(square, 0ULL);
+    case PieceType::kRook:
+      return move_gen::rook_moves(square, 0ULL);
+    case PieceType::kQueen:
+      return move_gen::bishop_moves(square, 0ULL) | move_gen::rook_moves(square, 0ULL);
+    default:
+      return move_gen::king_attacks(square);
+  }
+}
+
+}  // namespace
+
+void init_tables() {
+  keys.fill(0);
+  moves.fill(Move::null_move());
+
+  for (Color color : {Color::kBlack, Color::kWhite}) {
+    for (int piece = PieceType::kKnight; piece <= PieceType::kKing; piece++) {
+      for (int from = 0; from < Square::kSquareCount; from++) {
+        for (int to = from + 1; to < Square::kSquareCount; to++) {
+          if (!(empty_board_attacks(PieceType(piece), Square(from)) & BitBoard::from_square(to))) {
+            continue;
+          }
+
+          // a move changes the key by its piece's keys on both squares, and the turn
+          U64 key = zobrist::hash_piece(Square(from), color, PieceType(piece)) ^
+                    zobrist::hash_piece(Square(to), color, PieceType(piece)) ^
+                    zobrist::kRandomsArray[zobrist::Indices::kTurn];
+          Move move(from, to);
+
+          // insert the move, evicting whichever move is in its slot to that move's other slot, until a slot is empty
+          int index = first_index(key);
+          while (true) {
+            std::swap(keys[index], key);
+            std::swap(moves[index], move);
+
+            if (move.is_null()) {
+              break;
+            }
+
+            index = index == first_index(key) ? second_index(key) : first_index(key);
+          }
+        }
+      }
+    }
+  }
+}
+
+Move find_move(U64 key_difference) {
+  int index = first_index(key_difference);
+  if (keys[index] == key_difference) {
+    return moves[index];
+  }
+
+  index = second_index(key_difference);
+  if (keys[index] == key_difference) {
+    return moves[index];
+  }
+
+  return Move::null_move();
+}
+
+}
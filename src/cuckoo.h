@@ -0,0 +1,21 @@
+#ifndef INTEGRAL_CUCKOO_H_
+#define INTEGRAL_CUCKOO_H_
+
+#include "move.h"
+#include "types.h"
+
+// cuckoo hash tables of every reversible move's effect on the zobrist key, used to detect that the side to move can
+// repeat a position with a single move (see Board::has_upcoming_repetition)
+// based on "Detecting Repetitions with Cuckoo Tables" by Marcel van Kervinck
+namespace cuckoo {
+
+// must be called after the attack tables are initialized
+void init_tables();
+
+// returns the reversible move that changes a position's key by key_difference (both directions are the same move), or
+// a null move if there isn't one
+[[nodiscard]] Move find_move(U64 key_difference);
+
+}
+
+#endif // INTEGRAL_CUCKOO_H_
@@ -0,0 +1,87 @@
+// entry point of the cpu dispatching build, which links in one copy of the engine per x86-64 level (see CMakeLists.txt)
+// each copy only exports its entry point, and its static initializers are moved out of .init_array into a section of
+// its own, so nothing of a copy the cpu can't execute ever runs. at startup, cpuid decides which copy is used
+
+#include <cpuid.h>
+
+#include <array>
+
+int integral_main_v1(int argc, char **argv);
+int integral_main_v3(int argc, char **argv);
+int integral_main_v4(int argc, char **argv);
+
+using Initializer = void (*)();
+
+// the linker defines these around each copy's initializer section
+extern "C" Initializer __start_integral_init_v1[], __stop_integral_init_v1[];
+extern "C" Initializer __start_integral_init_v3[], __stop_integral_init_v3[];
+extern "C" Initializer __start_integral_init_v4[], __stop_integral_init_v4[];
+
+namespace {
+
+struct Variant {
+  int (*entry_point)(int, char **);
+  Initializer *initializers_begin;
+  Initializer *initializers_end;
+};
+
+struct Registers {
+  unsigned int eax, ebx, ecx, edx;
+};
+
+Registers cpuid(unsigned int leaf, unsigned int subleaf = 0) {
+  Registers registers{};
+  __cpuid_count(leaf, subleaf, registers.eax, registers.ebx, registers.ecx, registers.edx);
+  return registers;
+}
+
+// the register state the os saves on context switches, the avx and avx-512 registers are only usable if it's saved
+unsigned long long xgetbv() {
+  unsigned int eax, edx;
+  asm volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+
+bool has_bits(unsigned long long value, unsigned long long bits) {
+  return (value & bits) == bits;
+}
+
+// returns the highest of the x86-64 levels 1, 3 and 4 that the cpu and os support
+int detect_level() {
+  if (__get_cpuid_max(0, nullptr) < 7 || __get_cpuid_max(0x80000000, nullptr) < 0x80000001) {
+    return 1;
+  }
+
+  const auto basic = cpuid(1), extended = cpuid(7), amd_extended = cpuid(0x80000001);
+
+  // x86-64-v3 includes everything from x86-64-v2
+  const bool supports_v3 = has_bits(basic.ecx,
+                                    bit_SSE3 | bit_SSSE3 | bit_FMA | bit_CMPXCHG16B | bit_SSE4_1 | bit_SSE4_2 |
+                                        bit_MOVBE | bit_POPCNT | bit_XSAVE | bit_OSXSAVE | bit_AVX | bit_F16C) &&
+                           has_bits(extended.ebx, bit_BMI | bit_AVX2 | bit_BMI2) &&
+                           has_bits(amd_extended.ecx, bit_LAHF_LM | bit_ABM) &&
+                           has_bits(xgetbv(), 0x6);
+  if (!supports_v3) {
+    return 1;
+  }
+
+  const bool supports_v4 =
+      has_bits(extended.ebx, bit_AVX512F | bit_AVX512DQ | bit_AVX512CD | bit_AVX512BW | bit_AVX512VL) &&
+      has_bits(xgetbv(), 0xE6);
+  return supports_v4 ? 4 : 3;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const int level = detect_level();
+  const Variant variant = level == 4   ? Variant{integral_main_v4, __start_integral_init_v4, __stop_integral_init_v4}
+                          : level == 3 ? Variant{integral_main_v3, __start_integral_init_v3, __stop_integral_init_v3}
+                                       : Variant{integral_main_v1, __start_integral_init_v1, __stop_integral_init_v1};
+
+  for (auto initializer = variant.initializers_begin; initializer != variant.initializers_end; initializer++) {
+    (*initializer)();
+  }
+
+  return variant.entry_point(argc, argv);
+}
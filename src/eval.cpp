@@ -1,154 +1,112 @@
 #include "eval.h"
+#include "eval_trace.h"
+#include "eval_weights.h"
 
 #include "move_gen.h"
 
-// evaluation is exactly the same as PeSTO's texel-tuned tables. using this evaluation over my own gained some +200 elo
-// this will likely be reverted (even if it lowers the elo), as I don't like the idea of using someone else's evaluation
+// the weights started out as PeSTO's texel-tuned tables, which gained some +200 elo over my own evaluation
+// they live in eval_weights.h, which the tune tool rewrites when retuning them on our own games
 namespace eval {
 
-// clang-format off
-const std::array<std::array<int, 64>, PieceType::kNumTypes> kMiddleGameTables = {{
-    // pawns
-    {
-        0,   0,   0,   0,   0,   0,  0,   0,
-        98, 134,  61,  95,  68, 126, 34, -11,
-        -6,   7,  26,  31,  65,  56, 25, -20,
-        -14,  13,   6,  21,  23,  12, 17, -23,
-        -27,  -2,  -5,  12,  17,   6, 10, -25,
-        -26,  -4,  -4, -10,   3,   3, 33, -12,
-        -35,  -1, -20, -23, -15,  24, 38, -22,
-        0,   0,   0,   0,   0,   0,  0,   0,
-    },
-    // knights
-    {
-        -167, -89, -34, -49,  61, -97, -15, -107,
-        -73, -41,  72,  36,  23,  62,   7,  -17,
-        -47,  60,  37,  65,  84, 129,  73,   44,
-        -9,  17,  19,  53,  37,  69,  18,   22,
-        -13,   4,  16,  13,  28,  19,  21,   -8,
-        -23,  -9,  12,  10,  19,  17,  25,  -16,
-        -29, -53, -12,  -3,  -1,  18, -14,  -19,
-        -105, -21, -58, -33, -17, -28, -19,  -23,
-    },
-    // bishops
-    {
-        -29,   4, -82, -37, -25, -42,   7,  -8,
-        -26,  16, -18, -13,  30,  59,  18, -47,
-        -16,  37,  43,  40,  35,  50,  37,  -2,
-        -4,   5,  19,  50,  37,  37,   7,  -2,
-        -6,  13,  13,  26,  34,  12,  10,   4,
-        0,  15,  15,  15,  14,  27,  18,  10,
-        4,  15,  16,   0,   7,  21,  33,   1,
-        -33,  -3, -14, -21, -13, -12, -39, -21,
-    },
-    // rooks
-    {
-        32,  42,  32,  51, 63,  9,  31,  43,
-        27,  32,  58,  62, 80, 67,  26,  44,
-        -5,  19,  26,  36, 17, 45,  61,  16,
-        -24, -11,   7,  26, 24, 35,  -8, -20,
-        -36, -26, -12,  -1,  9, -7,   6, -23,
-        -45, -25, -16, -17,  3,  0,  -5, -33,
-        -44, -16, -20,  -9, -1, 11,  -6, -71,
-        -19, -13,   1,  17, 16,  7, -37, -26,
-    },
-    // queens
-    {
-        -28,   0,  29,  12,  59,  44,  43,  45,
-        -24, -39,  -5,   1, -16,  57,  28,  54,
-        -13, -17,   7,   8,  29,  56,  47,  57,
-        -27, -27, -16, -16,  -1,  17,  -2,   1,
-        -9, -26,  -9, -10,  -2,  -4,   3,  -3,
-        -14,   2, -11,  -2,  -5,   2,  14,   5,
-        -35,  -8,  11,   2,   8,  15,  -3,   1,
-        -1, -18,  -9,  10, -15, -25, -31, -50,
-    },
-    // king
-    {
-        -65,  23,  16, -15, -56, -34,   2,  13,
-        29,  -1, -20,  -7,  -8,  -4, -38, -29,
-        -9,  24,   2, -16, -20,   6,  22, -22,
-        -17, -20, -12, -27, -30, -25, -14, -36,
-        -49,  -1, -27, -39, -46, -44, -33, -51,
-        -14, -14, -22, -46, -44, -30, -15, -27,
-        1,   7,  -8, -64, -43, -16,   9,   8,
-        -15,  36,  12, -54,   8, -28,  24,  14,
+#ifdef EVAL_TUNING
+thread_local Trace *current_trace = nullptr;
+#endif
+
+std::array<std::array<std::array<PackedScore, Square::kSquareCount>, PieceType::kNumTypes>, 2> piece_square_table{};
+
+// squares in front of a pawn on its own file, and on its own and adjacent files
+std::array<std::array<BitBoard, Square::kSquareCount>, 2> forward_file_masks{};
+std::array<std::array<BitBoard, Square::kSquareCount>, 2> passed_pawn_masks{};
+std::array<BitBoard, kNumFiles> adjacent_file_masks{};
+
+void init_tables() {
+  for (int piece = PieceType::kPawn; piece < PieceType::kNumTypes; piece++) {
+    for (int square = 0; square < Square::kSquareCount; square++) {
+      for (const Color color : {Color::kBlack, Color::kWhite}) {
+        const auto table_square = relative_square(Square(square), color);
+        PackedScore score = kPieceValues[piece];
+        score += kPieceSquareTable[piece][table_square];
+        piece_square_table[color][piece][square] = color == Color::kWhite ? score : -score;
+      }
     }
-}};
-
-const std::array<std::array<int, 64>, PieceType::kNumTypes> kEndGameTables = {{
-    // pawns
-    {
-        0,   0,   0,   0,   0,   0,   0,   0,
-        178, 173, 158, 134, 147, 132, 165, 187,
-        94, 100,  85,  67,  56,  53,  82,  84,
-        32,  24,  13,   5,  -2,   4,  17,  17,
-        13,   9,  -3,  -7,  -7,  -8,   3,  -1,
-        4,   7,  -6,   1,   0,  -5,  -1,  -8,
-        13,   8,   8,  10,  13,   0,   2,  -7,
-        0,   0,   0,   0,   0,   0,   0,   0,
-    },
-    // knights
-    {
-        -58, -38, -13, -28, -31, -27, -63, -99,
-        -25,  -8, -25,  -2,  -9, -25, -24, -52,
-        -24, -20,  10,   9,  -1,  -9, -19, -41,
-        -17,   3,  22,  22,  22,  11,   8, -18,
-        -18,  -6,  16,  25,  16,  17,   4, -18,
-        -23,  -3,  -1,  15,  10,  -3, -20, -22,
-        -42, -20, -10,  -5,  -2, -20, -23, -44,
-        -29, -51, -23, -15, -22, -18, -50, -64,
-    },
-    // bishops
-    {
-        -14, -21, -11,  -8, -7,  -9, -17, -24,
-        -8,  -4,   7, -12, -3, -13,  -4, -14,
-        2,  -8,   0,  -1, -2,   6,   0,   4,
-        -3,   9,  12,   9, 14,  10,   3,   2,
-        -6,   3,  13,  19,  7,  10,  -3,  -9,
-        -12,  -3,   8,  10, 13,   3,  -7, -15,
-        -14, -18,  -7,  -1,  4,  -9, -15, -27,
-        -23,  -9, -23,  -5, -9, -16,  -5, -17,
-    },
-    // rooks
-    {
-        13, 10, 18, 15, 12,  12,   8,   5,
-        11, 13, 13, 11, -3,   3,   8,   3,
-        7,  7,  7,  5,  4,  -3,  -5,  -3,
-        4,  3, 13,  1,  2,   1,  -1,   2,
-        3,  5,  8,  4, -5,  -6,  -8, -11,
-        -4,  0, -5, -1, -7, -12,  -8, -16,
-        -6, -6,  0,  2, -9,  -9, -11,  -3,
-        -9,  2,  3, -1, -5, -13,   4, -20,
-    },
-    // queens
-    {
-        -9,  22,  22,  27,  27,  19,  10,  20,
-        -17,  20,  32,  41,  58,  25,  30,   0,
-        -20,   6,   9,  49,  47,  35,  19,   9,
-        3,  22,  24,  45,  57,  40,  57,  36,
-        -18,  28,  19,  47,  31,  34,  39,  23,
-        -16, -27,  15,   6,   9,  17,  10,   5,
-        -22, -23, -30, -16, -16, -23, -36, -32,
-        -33, -28, -22, -43,  -5, -32, -20, -41,
-    },
-    // king
-    {
-        -74, -35, -18, -18, -11,  15,   4, -17,
-        -12,  17,  14,  17,  17,  38,  23,  11,
-        10,  17,  23,  15,  20,  45,  44,  13,
-        -8,  22,  24,  27,  26,  33,  26,   3,
-        -18,  -4,  21,  24,  27,  23,   9, -11,
-        -19,  -3,  11,  21,  23,  16,   7,  -9,
-        -27, -11,   4,  13,  14,   4,  -5, -17,
-        -53, -34, -21, -11, -28, -14, -24, -43
+  }
+
+  for (int file = 0; file < kNumFiles; file++) {
+    adjacent_file_masks[file] = (file > 0 ? static_cast<U64>(kFileMasks[file - 1]) : 0ULL) |
+                                (file < 7 ? static_cast<U64>(kFileMasks[file + 1]) : 0ULL);
+  }
+
+  for (int square = 0; square < Square::kSquareCount; square++) {
+    for (const Color color : {Color::kBlack, Color::kWhite}) {
+      BitBoard forward = 0;
+      for (int rank = ::rank(square) + 1; color == Color::kWhite && rank < kNumRanks; rank++) {
+        forward |= kRankMasks[rank];
+      }
+      for (int rank = ::rank(square) - 1; color == Color::kBlack && rank >= 0; rank--) {
+        forward |= kRankMasks[rank];
+      }
+
+      forward_file_masks[color][square] = forward & kFileMasks[file(square)];
+      passed_pawn_masks[color][square] = forward & (adjacent_file_masks[file(square)] | kFileMasks[file(square)]);
     }
-}};
-// clang-format on
+  }
+}
+
+// squares attacked by all pawns of a side
+BitBoard pawn_attacks(BitBoard pawns, Color color) {
+  return color == Color::kWhite ? shift<Direction::kNorthEast>(pawns) | shift<Direction::kNorthWest>(pawns)
+                                : shift<Direction::kSouthEast>(pawns) | shift<Direction::kSouthWest>(pawns);
+}
+
+// evaluates the pawn structure from scratch into a pawn table entry
+void evaluate_pawn_structure(const BoardState &state, PawnTable::Entry &entry) {
+  entry.key = state.pawn_key;
+  entry.score = PackedScore();
 
-const std::array<int, PieceType::kNumTypes> kGamePhaseIncrements = {0, 1, 1, 2, 4, 0};
-const std::array<int, PieceType::kNumTypes> kMiddleGamePieceValues = {82, 337, 365, 477, 1025, 0};
-const std::array<int, PieceType::kNumTypes> kEndGamePieceValues = {94, 281, 297, 512, 936, 0};
+  for (const Color us : {Color::kBlack, Color::kWhite}) {
+    const Color them = flip_color(us);
+    const BitBoard our_pawns = state.pawns(us), their_pawns = state.pawns(them);
+    const BitBoard their_pawn_attacks = pawn_attacks(their_pawns, them);
+
+    PackedScore score;
+
+    BitBoard pawns = our_pawns;
+    while (pawns) {
+      const auto square = Square(pawns.pop_lsb());
+      const int pawn_file = file(square);
+
+      const BitBoard adjacent_pawns = our_pawns & adjacent_file_masks[pawn_file];
+      // a pawn with a friendly pawn in front of it on the same file is doubled, only the frontmost can be passed
+      const bool doubled = static_cast<bool>(our_pawns & forward_file_masks[us][square]);
+
+      if (!doubled && !(their_pawns & passed_pawn_masks[us][square])) {
+        score += kPassedPawnBonus[rank(relative_square(square, us))];
+        if (auto trace = active_trace()) trace->passed_pawns[rank(relative_square(square, us))][us]++;
+      }
+
+      if (doubled) {
+        score += kDoubledPawnPenalty;
+        if (auto trace = active_trace()) trace->doubled_pawns[us]++;
+      }
+
+      if (!adjacent_pawns) {
+        score += kIsolatedPawnPenalty;
+        if (auto trace = active_trace()) trace->isolated_pawns[us]++;
+      } else {
+        // backward: every adjacent pawn is ahead of it, so none can come to support it, and advancing it to its stop
+        // square walks into an enemy pawn's attack
+        const auto stop_square = us == Color::kWhite ? square + kBoardLength : square - kBoardLength;
+        const bool supportable = static_cast<bool>(adjacent_pawns & ~passed_pawn_masks[us][square]);
+        if (!supportable && their_pawn_attacks.is_set(stop_square)) {
+          score += kBackwardPawnPenalty;
+          if (auto trace = active_trace()) trace->backward_pawns[us]++;
+        }
+      }
+    }
+
+    entry.score += us == Color::kWhite ? score : -score;
+  }
+}
 
 bool is_mate_score(int evaluation) {
   return kMateScore - std::abs(evaluation) <= kMaxPlyFromRoot;
@@ -165,7 +123,7 @@ int mate_in(int evaluation) {
   return evaluation;
 }
 
-bool static_exchange(const Move &move, int threshold, const BoardState &state) {
+bool static_exchange(const Move &move, int threshold, const BoardState &state, AttackInfo &attack_info) {
   const auto from = move.get_from();
   const auto to = move.get_to();
 
@@ -175,6 +133,14 @@ bool static_exchange(const Move &move, int threshold, const BoardState &state) {
     return threshold <= 0;
   }
 
+  // the exchange ends right away if the opponent can't recapture: the square isn't attacked, and there's no slider
+  // on the line through the moving piece's squares that could see through the square it leaves
+  const Color them = flip_color(state.turn);
+  const BitBoard their_sliders = state.bishops(them) | state.rooks(them) | state.queens(them);
+  if (!attack_info.attacked(state, them).is_set(to) && !(move_gen::ray_intersecting(from, to) & their_sliders)) {
+    return kSEEPieceScores[state.get_piece_type(to)] >= threshold;
+  }
+
   // score represents the maximum number of points the opponent can gain with the next capture
   int score = kSEEPieceScores[state.get_piece_type(to)] - threshold;
   // if the captured piece is worth less than what we can give up, we lose
@@ -294,84 +260,114 @@ bool static_exchange(const Move &move, int threshold, const BoardState &state) {
   return state.turn == winner;
 }
 
-std::pair<int, int> evaluate_material(const BoardState &state) {
-  int mg_material = 0;
-  int eg_material = 0;
-
-  const Color us = state.turn, them = flip_color(us);
-
-  const BitBoard our_pieces = state.occupied(us);
-  const BitBoard their_pieces = state.occupied(them);
-
-  const BitBoard pawns = state.pawns();
-  const BitBoard knights = state.knights();
-  const BitBoard bishops = state.bishops();
-  const BitBoard rooks = state.rooks();
-  const BitBoard queens = state.queens();
-
-  const int pawn_count = (pawns & our_pieces).pop_count() - (pawns & their_pieces).pop_count();
-  const int knight_count = (knights & our_pieces).pop_count() - (knights & their_pieces).pop_count();
-  const int bishop_count = (bishops & our_pieces).pop_count() - (bishops & their_pieces).pop_count();
-  const int rook_count = (rooks & our_pieces).pop_count() - (rooks & their_pieces).pop_count();
-  const int queen_count = (queens & our_pieces).pop_count() - (queens & their_pieces).pop_count();
-  
-  mg_material += kMiddleGamePieceValues[PieceType::kPawn] * pawn_count;
-  mg_material += kMiddleGamePieceValues[PieceType::kKnight] * knight_count;
-  mg_material += kMiddleGamePieceValues[PieceType::kBishop] * bishop_count;
-  mg_material += kMiddleGamePieceValues[PieceType::kRook] * rook_count;
-  mg_material += kMiddleGamePieceValues[PieceType::kQueen] * queen_count;
-  
-  eg_material += kEndGamePieceValues[PieceType::kPawn] * pawn_count;
-  eg_material += kEndGamePieceValues[PieceType::kKnight] * knight_count;
-  eg_material += kEndGamePieceValues[PieceType::kBishop] * bishop_count;
-  eg_material += kEndGamePieceValues[PieceType::kRook] * rook_count;
-  eg_material += kEndGamePieceValues[PieceType::kQueen] * queen_count;
-
-  return {mg_material, eg_material};
-}
-
-int evaluate(const BoardState &state) {
-  auto [middle_game_score, end_game_score] = evaluate_material(state);
+// computes the piece-square score and game phase of the board from scratch, which the board state keeps incrementally
+std::pair<PackedScore, int> compute_piece_square_score(const BoardState &state) {
+  PackedScore piece_square_score;
+  int phase = 0;
 
-  int middle_game_phase = 0;
-  middle_game_phase += kGamePhaseIncrements[PieceType::kPawn] * state.pawns().pop_count();
-  middle_game_phase += kGamePhaseIncrements[PieceType::kKnight] * state.knights().pop_count();
-  middle_game_phase += kGamePhaseIncrements[PieceType::kBishop] * state.bishops().pop_count();
-  middle_game_phase += kGamePhaseIncrements[PieceType::kRook] * state.rooks().pop_count();
-  middle_game_phase += kGamePhaseIncrements[PieceType::kQueen] * state.queens().pop_count();
+  BitBoard pieces = state.occupied();
+  while (pieces) {
+    const auto square = Square(pieces.pop_lsb());
+    const auto piece = state.get_piece_type(square);
 
-  const Color us = state.turn, them = flip_color(us);
+    const auto color = state.get_piece_color(square);
 
-  BitBoard our_pieces = state.occupied(us);
-  while (our_pieces) {
-    const auto square = Square(our_pieces.pop_lsb());
-    const auto piece = state.get_piece_type(square);
+    piece_square_score += piece_square_table[color][piece][square];
+    phase += kGamePhaseIncrements[piece];
 
-    middle_game_score += kMiddleGameTables[piece][relative_square(square, us)];
-    end_game_score += kEndGameTables[piece][relative_square(square, us)];
+    if (auto trace = active_trace()) {
+      trace->piece_values[piece][color]++;
+      trace->piece_squares[piece][relative_square(square, color)][color]++;
+    }
   }
 
-  BitBoard their_pieces = state.occupied(them);
-  while (their_pieces) {
-    const auto square = Square(their_pieces.pop_lsb());
-    const auto piece = state.get_piece_type(square);
+  return {piece_square_score, phase};
+}
+
+U64 compute_material_key(const BoardState &state) {
+  U64 key = 0;
 
-    middle_game_score -= kMiddleGameTables[piece][relative_square(square, them)];
-    end_game_score -= kEndGameTables[piece][relative_square(square, them)];
+  BitBoard pieces = state.occupied();
+  while (pieces) {
+    const auto square = Square(pieces.pop_lsb());
+    key += material_key_increment(state.get_piece_color(square), state.get_piece_type(square));
   }
 
-  // tapered evaluation
-  const int kMaxMiddleGamePhase = 24;
+  return key;
+}
+
+int evaluate(const BoardState &state, PawnTable &pawn_table, const MaterialTable::Entry &material) {
+  // verify the incrementally updated scores and keys haven't drifted away from the real ones
+  assert(compute_piece_square_score(state) == std::make_pair(state.piece_square_score, state.phase));
+  assert(state.pawn_key == zobrist::generate_pawn_key(state));
+
+  auto &pawn_entry = pawn_table.probe(state.pawn_key);
+  if (pawn_entry.key != state.pawn_key || kTracingEnabled) {
+    evaluate_pawn_structure(state, pawn_entry);
+  }
 
-  middle_game_phase = std::min(middle_game_phase, kMaxMiddleGamePhase);
-  const int end_game_phase = kMaxMiddleGamePhase - middle_game_phase;
+  PackedScore white_score = state.piece_square_score;
+  white_score += pawn_entry.score;
+  white_score += material.imbalance;
+
+  const auto packed_score = state.turn == Color::kWhite ? white_score : -white_score;
+
+  // tapered evaluation, drawish endgames scale down the end game score
+  const int middle_game_phase = std::min(state.phase, kMaxGamePhase);
+  const int end_game_phase = kMaxGamePhase - middle_game_phase;
+  const int scale = scale_factor(material, state);
+  const int end_game_score = packed_score.end_game() * scale / kScaleNormal;
+
+  if (auto trace = active_trace()) {
+    // the piece-square terms are kept incrementally, so trace them by computing the score from scratch
+    trace->piece_values = {};
+    trace->piece_squares = {};
+    compute_piece_square_score(state);
+    trace->phase = middle_game_phase;
+    trace->scale = scale;
+    trace->hand_crafted = true;
+  }
 
-  int score = (middle_game_score * middle_game_phase + end_game_score * end_game_phase) / kMaxMiddleGamePhase;
+  int score = (packed_score.middle_game() * middle_game_phase + end_game_score * end_game_phase) / kMaxGamePhase;
 
-  const int kTempoBonus = 10;
   score += kTempoBonus;
 
   return score;
 }
 
+int evaluate(Board &board) {
+  const auto &state = board.get_state();
+
+  auto &eval_cache = board.get_eval_cache();
+  if (int score; !kTracingEnabled && eval_cache.probe(state.zobrist_key, score)) {
+    return score;
+  }
+
+  assert(state.material_key == compute_material_key(state));
+
+  // known endgames are evaluated by their specialised evaluator whichever evaluation is in use
+  const auto &material = board.get_material_table().probe(state.material_key);
+
+  int score;
+  if (material.is_draw) {
+    score = kDrawScore;
+  } else if (material.evaluator != MaterialTable::Evaluator::kNone) {
+    score = evaluate_endgame(material, state);
+  } else if (!nnue::is_enabled()) {
+    score = evaluate(state, board.get_pawn_table(), material);
+  } else {
+#ifndef NDEBUG
+    // verify the incrementally updated accumulator matches one computed from scratch
+    nnue::Accumulator refreshed;
+    nnue::refresh(state, refreshed);
+    assert(refreshed == board.get_accumulator());
+#endif
+
+    score = nnue::evaluate(board.get_accumulator(), state.turn);
+  }
+
+  eval_cache.save(state.zobrist_key, score);
+  return score;
+}
+
 }  // namespace eval
\ No newline at end of file
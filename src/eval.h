@@ -23,9 +23,18 @@ bool is_mate_score(int evaluation);
 
 int mate_in(int evaluation);
 
-bool static_exchange(const Move &move, int threshold, const BoardState &state);
+bool static_exchange(const Move &move, int threshold, const BoardState &state, AttackInfo &attack_info);
 
-int evaluate(const BoardState &state);
+// hand-crafted evaluation, the pawn-structure terms are cached in the pawn table
+int evaluate(const BoardState &state, PawnTable &pawn_table, const MaterialTable::Entry &material);
+
+// evaluates with the nnue if a network is loaded and enabled, otherwise with the hand-crafted evaluation
+// the result is cached in the board's eval cache, which must be cleared when the evaluation function changes
+int evaluate(Board &board);
+
+std::pair<PackedScore, int> compute_piece_square_score(const BoardState &state);
+
+U64 compute_material_key(const BoardState &state);
 
 }
 
@@ -0,0 +1,17 @@
+#include "eval_cache.h"
+
+#include <algorithm>
+
+namespace eval {
+
+EvalCache::EvalCache() : table_(kNumEntries), probes_(0), hits_(0) {}
+
+void EvalCache::clear() {
+  std::ranges::fill(table_, Entry{});
+}
+
+void EvalCache::reset_stats() {
+  probes_ = hits_ = 0;
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef INTEGRAL_EVAL_CACHE_H_
+#define INTEGRAL_EVAL_CACHE_H_
+
+#include "types.h"
+
+#include <vector>
+
+namespace eval {
+
+// small direct-mapped cache of static evaluations by zobrist key, so positions whose transposition table entry was
+// missed or overwritten don't have to be evaluated again
+// entries are simply overwritten on collision, the full key is stored so a hit is always the same position
+class EvalCache {
+ public:
+  struct Entry {
+    Entry() : key(0ULL), score(0) {}
+
+    U64 key;
+    int score;
+  };
+
+  static constexpr std::size_t kNumEntries = 1 << 16;
+
+  EvalCache();
+
+  void clear();
+
+  [[nodiscard]] inline bool probe(const U64 &key, int &score) {
+    probes_++;
+
+    const auto &entry = table_[key & (kNumEntries - 1)];
+    if (entry.key != key) {
+      return false;
+    }
+
+    hits_++;
+    score = entry.score;
+    return true;
+  }
+
+  inline void save(const U64 &key, int score) {
+    auto &entry = table_[key & (kNumEntries - 1)];
+    entry.key = key;
+    entry.score = score;
+  }
+
+  [[nodiscard]] U64 get_probes() const {
+    return probes_;
+  }
+
+  [[nodiscard]] U64 get_hits() const {
+    return hits_;
+  }
+
+  void reset_stats();
+
+ private:
+  std::vector<Entry> table_;
+  U64 probes_;
+  U64 hits_;
+};
+
+}
+
+#endif // INTEGRAL_EVAL_CACHE_H_
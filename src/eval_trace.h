@@ -0,0 +1,49 @@
+#ifndef INTEGRAL_EVAL_TRACE_H_
+#define INTEGRAL_EVAL_TRACE_H_
+
+#include "bitboard.h"
+
+#include <array>
+
+// records how often each evaluation weight was applied for each side, which makes the hand-crafted evaluation a linear
+// function of its weights that the tuner can compute gradients of
+// only compiled in for the tune tool (EVAL_TUNING), where every cache is bypassed so each term is traced
+namespace eval {
+
+#ifdef EVAL_TUNING
+constexpr bool kTracingEnabled = true;
+#else
+constexpr bool kTracingEnabled = false;
+#endif
+
+struct Trace {
+  std::array<std::array<int, 2>, PieceType::kNumTypes> piece_values;
+  std::array<std::array<std::array<int, 2>, Square::kSquareCount>, PieceType::kNumTypes> piece_squares;
+  std::array<std::array<int, 2>, kNumRanks> passed_pawns;
+  std::array<int, 2> isolated_pawns;
+  std::array<int, 2> doubled_pawns;
+  std::array<int, 2> backward_pawns;
+  std::array<int, 2> bishop_pairs;
+  // the game phase and end game scale factor the score was tapered with
+  int phase;
+  int scale;
+  // false when the score didn't come from the hand-crafted evaluation (known endgames, insufficient material)
+  bool hand_crafted;
+};
+
+#ifdef EVAL_TUNING
+// the trace the calling thread is recording into, if any
+extern thread_local Trace *current_trace;
+
+inline Trace *active_trace() {
+  return current_trace;
+}
+#else
+constexpr Trace *active_trace() {
+  return nullptr;
+}
+#endif
+
+}
+
+#endif // INTEGRAL_EVAL_TRACE_H_
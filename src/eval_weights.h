@@ -0,0 +1,146 @@
+#ifndef INTEGRAL_EVAL_WEIGHTS_H_
+#define INTEGRAL_EVAL_WEIGHTS_H_
+
+#include "psqt.h"
+
+// evaluation weights, written by the tune tool (tools/tune.cpp)
+// the piece-square tables are laid out as seen from white's side of the board, starting with a8
+namespace eval {
+
+// clang-format off
+const std::array<PackedScore, PieceType::kNumTypes> kPieceValues = {
+    PackedScore(82, 94), PackedScore(337, 281), PackedScore(365, 297), PackedScore(477, 512), PackedScore(1025, 936), PackedScore(0, 0)
+};
+
+const std::array<std::array<PackedScore, Square::kSquareCount>, PieceType::kNumTypes> kPieceSquareTable = {{
+    // pawns
+    {
+        PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0),
+        PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0),
+        PackedScore(98, 178), PackedScore(134, 173), PackedScore(61, 158), PackedScore(95, 134),
+        PackedScore(68, 147), PackedScore(126, 132), PackedScore(34, 165), PackedScore(-11, 187),
+        PackedScore(-6, 94), PackedScore(7, 100), PackedScore(26, 85), PackedScore(31, 67),
+        PackedScore(65, 56), PackedScore(56, 53), PackedScore(25, 82), PackedScore(-20, 84),
+        PackedScore(-14, 32), PackedScore(13, 24), PackedScore(6, 13), PackedScore(21, 5),
+        PackedScore(23, -2), PackedScore(12, 4), PackedScore(17, 17), PackedScore(-23, 17),
+        PackedScore(-27, 13), PackedScore(-2, 9), PackedScore(-5, -3), PackedScore(12, -7),
+        PackedScore(17, -7), PackedScore(6, -8), PackedScore(10, 3), PackedScore(-25, -1),
+        PackedScore(-26, 4), PackedScore(-4, 7), PackedScore(-4, -6), PackedScore(-10, 1),
+        PackedScore(3, 0), PackedScore(3, -5), PackedScore(33, -1), PackedScore(-12, -8),
+        PackedScore(-35, 13), PackedScore(-1, 8), PackedScore(-20, 8), PackedScore(-23, 10),
+        PackedScore(-15, 13), PackedScore(24, 0), PackedScore(38, 2), PackedScore(-22, -7),
+        PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0),
+        PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0), PackedScore(0, 0),
+    },
+    // knights
+    {
+        PackedScore(-167, -58), PackedScore(-89, -38), PackedScore(-34, -13), PackedScore(-49, -28),
+        PackedScore(61, -31), PackedScore(-97, -27), PackedScore(-15, -63), PackedScore(-107, -99),
+        PackedScore(-73, -25), PackedScore(-41, -8), PackedScore(72, -25), PackedScore(36, -2),
+        PackedScore(23, -9), PackedScore(62, -25), PackedScore(7, -24), PackedScore(-17, -52),
+        PackedScore(-47, -24), PackedScore(60, -20), PackedScore(37, 10), PackedScore(65, 9),
+        PackedScore(84, -1), PackedScore(129, -9), PackedScore(73, -19), PackedScore(44, -41),
+        PackedScore(-9, -17), PackedScore(17, 3), PackedScore(19, 22), PackedScore(53, 22),
+        PackedScore(37, 22), PackedScore(69, 11), PackedScore(18, 8), PackedScore(22, -18),
+        PackedScore(-13, -18), PackedScore(4, -6), PackedScore(16, 16), PackedScore(13, 25),
+        PackedScore(28, 16), PackedScore(19, 17), PackedScore(21, 4), PackedScore(-8, -18),
+        PackedScore(-23, -23), PackedScore(-9, -3), PackedScore(12, -1), PackedScore(10, 15),
+        PackedScore(19, 10), PackedScore(17, -3), PackedScore(25, -20), PackedScore(-16, -22),
+        PackedScore(-29, -42), PackedScore(-53, -20), PackedScore(-12, -10), PackedScore(-3, -5),
+        PackedScore(-1, -2), PackedScore(18, -20), PackedScore(-14, -23), PackedScore(-19, -44),
+        PackedScore(-105, -29), PackedScore(-21, -51), PackedScore(-58, -23), PackedScore(-33, -15),
+        PackedScore(-17, -22), PackedScore(-28, -18), PackedScore(-19, -50), PackedScore(-23, -64),
+    },
+    // bishops
+    {
+        PackedScore(-29, -14), PackedScore(4, -21), PackedScore(-82, -11), PackedScore(-37, -8),
+        PackedScore(-25, -7), PackedScore(-42, -9), PackedScore(7, -17), PackedScore(-8, -24),
+        PackedScore(-26, -8), PackedScore(16, -4), PackedScore(-18, 7), PackedScore(-13, -12),
+        PackedScore(30, -3), PackedScore(59, -13), PackedScore(18, -4), PackedScore(-47, -14),
+        PackedScore(-16, 2), PackedScore(37, -8), PackedScore(43, 0), PackedScore(40, -1),
+        PackedScore(35, -2), PackedScore(50, 6), PackedScore(37, 0), PackedScore(-2, 4),
+        PackedScore(-4, -3), PackedScore(5, 9), PackedScore(19, 12), PackedScore(50, 9),
+        PackedScore(37, 14), PackedScore(37, 10), PackedScore(7, 3), PackedScore(-2, 2),
+        PackedScore(-6, -6), PackedScore(13, 3), PackedScore(13, 13), PackedScore(26, 19),
+        PackedScore(34, 7), PackedScore(12, 10), PackedScore(10, -3), PackedScore(4, -9),
+        PackedScore(0, -12), PackedScore(15, -3), PackedScore(15, 8), PackedScore(15, 10),
+        PackedScore(14, 13), PackedScore(27, 3), PackedScore(18, -7), PackedScore(10, -15),
+        PackedScore(4, -14), PackedScore(15, -18), PackedScore(16, -7), PackedScore(0, -1),
+        PackedScore(7, 4), PackedScore(21, -9), PackedScore(33, -15), PackedScore(1, -27),
+        PackedScore(-33, -23), PackedScore(-3, -9), PackedScore(-14, -23), PackedScore(-21, -5),
+        PackedScore(-13, -9), PackedScore(-12, -16), PackedScore(-39, -5), PackedScore(-21, -17),
+    },
+    // rooks
+    {
+        PackedScore(32, 13), PackedScore(42, 10), PackedScore(32, 18), PackedScore(51, 15),
+        PackedScore(63, 12), PackedScore(9, 12), PackedScore(31, 8), PackedScore(43, 5),
+        PackedScore(27, 11), PackedScore(32, 13), PackedScore(58, 13), PackedScore(62, 11),
+        PackedScore(80, -3), PackedScore(67, 3), PackedScore(26, 8), PackedScore(44, 3),
+        PackedScore(-5, 7), PackedScore(19, 7), PackedScore(26, 7), PackedScore(36, 5),
+        PackedScore(17, 4), PackedScore(45, -3), PackedScore(61, -5), PackedScore(16, -3),
+        PackedScore(-24, 4), PackedScore(-11, 3), PackedScore(7, 13), PackedScore(26, 1),
+        PackedScore(24, 2), PackedScore(35, 1), PackedScore(-8, -1), PackedScore(-20, 2),
+        PackedScore(-36, 3), PackedScore(-26, 5), PackedScore(-12, 8), PackedScore(-1, 4),
+        PackedScore(9, -5), PackedScore(-7, -6), PackedScore(6, -8), PackedScore(-23, -11),
+        PackedScore(-45, -4), PackedScore(-25, 0), PackedScore(-16, -5), PackedScore(-17, -1),
+        PackedScore(3, -7), PackedScore(0, -12), PackedScore(-5, -8), PackedScore(-33, -16),
+        PackedScore(-44, -6), PackedScore(-16, -6), PackedScore(-20, 0), PackedScore(-9, 2),
+        PackedScore(-1, -9), PackedScore(11, -9), PackedScore(-6, -11), PackedScore(-71, -3),
+        PackedScore(-19, -9), PackedScore(-13, 2), PackedScore(1, 3), PackedScore(17, -1),
+        PackedScore(16, -5), PackedScore(7, -13), PackedScore(-37, 4), PackedScore(-26, -20),
+    },
+    // queens
+    {
+        PackedScore(-28, -9), PackedScore(0, 22), PackedScore(29, 22), PackedScore(12, 27),
+        PackedScore(59, 27), PackedScore(44, 19), PackedScore(43, 10), PackedScore(45, 20),
+        PackedScore(-24, -17), PackedScore(-39, 20), PackedScore(-5, 32), PackedScore(1, 41),
+        PackedScore(-16, 58), PackedScore(57, 25), PackedScore(28, 30), PackedScore(54, 0),
+        PackedScore(-13, -20), PackedScore(-17, 6), PackedScore(7, 9), PackedScore(8, 49),
+        PackedScore(29, 47), PackedScore(56, 35), PackedScore(47, 19), PackedScore(57, 9),
+        PackedScore(-27, 3), PackedScore(-27, 22), PackedScore(-16, 24), PackedScore(-16, 45),
+        PackedScore(-1, 57), PackedScore(17, 40), PackedScore(-2, 57), PackedScore(1, 36),
+        PackedScore(-9, -18), PackedScore(-26, 28), PackedScore(-9, 19), PackedScore(-10, 47),
+        PackedScore(-2, 31), PackedScore(-4, 34), PackedScore(3, 39), PackedScore(-3, 23),
+        PackedScore(-14, -16), PackedScore(2, -27), PackedScore(-11, 15), PackedScore(-2, 6),
+        PackedScore(-5, 9), PackedScore(2, 17), PackedScore(14, 10), PackedScore(5, 5),
+        PackedScore(-35, -22), PackedScore(-8, -23), PackedScore(11, -30), PackedScore(2, -16),
+        PackedScore(8, -16), PackedScore(15, -23), PackedScore(-3, -36), PackedScore(1, -32),
+        PackedScore(-1, -33), PackedScore(-18, -28), PackedScore(-9, -22), PackedScore(10, -43),
+        PackedScore(-15, -5), PackedScore(-25, -32), PackedScore(-31, -20), PackedScore(-50, -41),
+    },
+    // king
+    {
+        PackedScore(-65, -74), PackedScore(23, -35), PackedScore(16, -18), PackedScore(-15, -18),
+        PackedScore(-56, -11), PackedScore(-34, 15), PackedScore(2, 4), PackedScore(13, -17),
+        PackedScore(29, -12), PackedScore(-1, 17), PackedScore(-20, 14), PackedScore(-7, 17),
+        PackedScore(-8, 17), PackedScore(-4, 38), PackedScore(-38, 23), PackedScore(-29, 11),
+        PackedScore(-9, 10), PackedScore(24, 17), PackedScore(2, 23), PackedScore(-16, 15),
+        PackedScore(-20, 20), PackedScore(6, 45), PackedScore(22, 44), PackedScore(-22, 13),
+        PackedScore(-17, -8), PackedScore(-20, 22), PackedScore(-12, 24), PackedScore(-27, 27),
+        PackedScore(-30, 26), PackedScore(-25, 33), PackedScore(-14, 26), PackedScore(-36, 3),
+        PackedScore(-49, -18), PackedScore(-1, -4), PackedScore(-27, 21), PackedScore(-39, 24),
+        PackedScore(-46, 27), PackedScore(-44, 23), PackedScore(-33, 9), PackedScore(-51, -11),
+        PackedScore(-14, -19), PackedScore(-14, -3), PackedScore(-22, 11), PackedScore(-46, 21),
+        PackedScore(-44, 23), PackedScore(-30, 16), PackedScore(-15, 7), PackedScore(-27, -9),
+        PackedScore(1, -27), PackedScore(7, -11), PackedScore(-8, 4), PackedScore(-64, 13),
+        PackedScore(-43, 14), PackedScore(-16, 4), PackedScore(9, -5), PackedScore(8, -17),
+        PackedScore(-15, -53), PackedScore(36, -34), PackedScore(12, -21), PackedScore(-54, -11),
+        PackedScore(8, -28), PackedScore(-28, -14), PackedScore(24, -24), PackedScore(14, -43),
+    },
+}};
+
+const std::array<PackedScore, kNumRanks> kPassedPawnBonus = {
+    PackedScore(0, 0), PackedScore(0, 10), PackedScore(5, 15), PackedScore(10, 25),
+    PackedScore(20, 45), PackedScore(35, 70), PackedScore(60, 110), PackedScore(0, 0)
+};
+
+const PackedScore kIsolatedPawnPenalty(-10, -15);
+const PackedScore kDoubledPawnPenalty(-10, -25);
+const PackedScore kBackwardPawnPenalty(-8, -10);
+const PackedScore kBishopPairBonus(30, 50);
+const int kTempoBonus = 10;
+// clang-format on
+
+}
+
+#endif // INTEGRAL_EVAL_WEIGHTS_H_
@@ -71,6 +71,7 @@ BoardState string_to_board(std::string fen_str) {
   stream >> state.fifty_moves_clock;
 
   state.zobrist_key = zobrist::generate_key(state);
+  state.pawn_key = zobrist::generate_pawn_key(state);
 
   return state;
 }
@@ -1,9 +1,41 @@
 #include "history.h"
+#include "eval.h"
 
-MoveHistory::MoveHistory(const BoardState &state) : state_(state) {}
+MoveHistory::MoveHistory(const BoardState &state) : state_(state), continuation_history_(2) {
+  clear();
+}
+
+int MoveHistory::get_quiet_history_score(const Move &move, Color turn, const Continuations &continuations) noexcept {
+  int score = butterfly_history_[turn][move.get_from()][move.get_to()];
+
+  const auto piece = state_.get_piece_type(move.get_from());
+  for (const auto entry : continuations) {
+    if (entry) {
+      score += (*entry)[piece][move.get_to()];
+    }
+  }
 
-const int &MoveHistory::get_history_score(const Move &move, Color turn) noexcept {
-  return butterfly_history_[turn][move.get_from()][move.get_to()];
+  return score;
+}
+
+MoveHistory::ContinuationEntry *MoveHistory::get_continuation_entry(const Move &move) {
+  // called before the move is made, so the piece is still on its from square
+  const auto from = move.get_from();
+  return &continuation_history_[state_.turn][state_.get_piece_type(from)][move.get_to()];
+}
+
+int &MoveHistory::capture_history_entry(const Move &move) {
+  const auto from = move.get_from(), to = move.get_to();
+  const auto piece = state_.get_piece_type(from);
+
+  // en passant is the only capture that doesn't land on the captured piece
+  const auto captured = piece == PieceType::kPawn && to == state_.en_passant ? PieceType::kPawn
+                                                                             : state_.get_piece_type(to);
+  return capture_history_[state_.turn][piece][to][captured];
+}
+
+int MoveHistory::get_capture_history_score(const Move &move) noexcept {
+  return capture_history_entry(move);
 }
 
 std::array<Move, 2> &MoveHistory::get_killers(int ply) {
@@ -32,37 +64,84 @@ void MoveHistory::update_counter_move(const Move &prev_move, const Move &counter
 
 const int kHistoryCap = 8192;
 
-void MoveHistory::update_move_history(const Move &move, List<Move, kMaxMoves>& quiet_non_cutoffs, Color turn, int depth) {
-  auto &move_history_score = butterfly_history_[turn][move.get_from()][move.get_to()];
+// apply a linear dampening to the bonus as the score approaches the cap
+void apply_history_bonus(int &score, int bonus) {
+  score += bonus - score * std::abs(bonus) / kHistoryCap;
+}
 
-  // apply a linear dampening to the bonus as the depth increases
+void MoveHistory::update_move_history(const Move &move,
+                                      List<Move, kMaxMoves> &quiet_non_cutoffs,
+                                      Color turn,
+                                      int depth,
+                                      const Continuations &continuations) {
   const int bonus = depth * depth;
-  const int scaled_bonus = bonus - move_history_score * std::abs(bonus) / kHistoryCap;
-  move_history_score += scaled_bonus;
+  update_quiet_history(move, turn, bonus, continuations);
 
   // lower the score of the quiet moves that did not cause a beta cutoff
   // a good side effect of this is that moves that caused a beta cutoff earlier and were awarded a bonus but no longer cause a beta cutoff are eventually "discarded"
-  penalize_move_history(quiet_non_cutoffs, turn, depth);
+  for (int i = 0; i < quiet_non_cutoffs.size(); i++) {
+    update_quiet_history(quiet_non_cutoffs[i], turn, -bonus, continuations);
+  }
+}
+
+void MoveHistory::update_quiet_history(const Move &move, Color turn, int bonus, const Continuations &continuations) {
+  apply_history_bonus(butterfly_history_[turn][move.get_from()][move.get_to()], bonus);
+
+  const auto piece = state_.get_piece_type(move.get_from());
+  for (const auto entry : continuations) {
+    if (entry) {
+      apply_history_bonus((*entry)[piece][move.get_to()], bonus);
+    }
+  }
 }
 
-void MoveHistory::penalize_move_history(List<Move, kMaxMoves>& moves, Color turn, int depth) {
-  const int bonus = -depth * depth;
-  for (int i = 0; i < moves.size(); i++) {
-    const auto &move = moves[i];
-    auto &move_history_score = butterfly_history_[turn][move.get_from()][move.get_to()];
+void MoveHistory::update_capture_history(const Move &best_move, List<Move, kMaxMoves> &capture_non_cutoffs, int depth) {
+  const int bonus = depth * depth;
+  if (best_move.is_capture(state_)) {
+    apply_history_bonus(capture_history_entry(best_move), bonus);
+  }
 
-    // apply a linear dampening to the bonus (penalty here) as the depth increases
-    const int scaled_bonus = bonus - move_history_score * std::abs(bonus) / kHistoryCap;
-    move_history_score += scaled_bonus;
+  for (int i = 0; i < capture_non_cutoffs.size(); i++) {
+    apply_history_bonus(capture_history_entry(capture_non_cutoffs[i]), -bonus);
   }
 }
 
-void MoveHistory::decay_move_history() {
-  for (auto &sides : butterfly_history_) {
-    for (auto &move_scores : sides) {
-      move_scores.fill(0);
+// applies the function to every score of a history table, however deeply it's nested
+template<typename Table>
+void for_each_score(Table &table, const auto &function) {
+  if constexpr (std::is_same_v<Table, int>) {
+    function(table);
+  } else {
+    for (auto &entry : table) {
+      for_each_score(entry, function);
     }
   }
+}
+
+void MoveHistory::age() {
+  // halving keeps the previous search's move ordering as a head start, while the new search's updates soon outweigh it
+  // counter moves are left alone, since any cutoff by a different reply replaces them anyway
+  const auto halve = [](int &score) {
+    score /= 2;
+  };
+  for_each_score(butterfly_history_, halve);
+  for_each_score(capture_history_, halve);
+  for_each_score(continuation_history_, halve);
+
+  // killers are only meaningful for the plies of the search that found them
+  for (auto &killers : killer_moves_) {
+    killers.fill(Move::null_move());
+  }
+}
+
+void MoveHistory::clear() {
+  const auto zero = [](int &score) {
+    score = 0;
+  };
+  for_each_score(butterfly_history_, zero);
+  for_each_score(capture_history_, zero);
+  for_each_score(continuation_history_, zero);
+
   for (auto &killers : killer_moves_) {
     killers.fill(Move::null_move());
   }
@@ -73,4 +152,36 @@ void MoveHistory::decay_move_history() {
 
 void MoveHistory::clear_killers(int ply) {
   killer_moves_[ply].fill(Move::null_move());
+}
+
+// corrections are stored with extra precision, since every update only moves them by a fraction of the error
+const int kCorrectionGrain = 256;
+const int kCorrectionWeightScale = 256;
+const int kMaxCorrection = kCorrectionGrain * 32;
+
+CorrectionHistory::CorrectionHistory() : pawn_corrections_({}) {}
+
+int CorrectionHistory::correct_static_eval(const BoardState &state, int static_eval) const {
+  const int correction = pawn_corrections_[state.turn][state.pawn_key % kNumEntries] / kCorrectionGrain;
+
+  // a corrected evaluation must never be mistaken for a mate score
+  const int kMaxEval = eval::kMateScore - kMaxPlyFromRoot - 1;
+  return std::clamp(static_eval + correction, -kMaxEval, kMaxEval);
+}
+
+void CorrectionHistory::update(const BoardState &state, int depth, int search_score, int static_eval) {
+  auto &correction = pawn_corrections_[state.turn][state.pawn_key % kNumEntries];
+
+  // deeper searches are more trustworthy, so they move the correction further toward their error
+  const int error = (search_score - static_eval) * kCorrectionGrain;
+  const int weight = std::min(depth + 1, 16);
+
+  correction = (correction * (kCorrectionWeightScale - weight) + error * weight) / kCorrectionWeightScale;
+  correction = std::clamp(correction, -kMaxCorrection, kMaxCorrection);
+}
+
+void CorrectionHistory::clear() {
+  for (auto &corrections : pawn_corrections_) {
+    corrections.fill(0);
+  }
 }
\ No newline at end of file
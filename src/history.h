@@ -4,12 +4,25 @@
 #include "move_gen.h"
 
 #include <array>
+#include <vector>
 
 class MoveHistory {
  public:
+  // continuation history of one move, scoring each (piece, to square) of the move that follows it
+  using ContinuationEntry = std::array<std::array<int, Square::kSquareCount>, PieceType::kNumTypes>;
+
+  // the continuation history entries of the moves one and two plies back, either can be null
+  using Continuations = std::array<ContinuationEntry *, 2>;
+
   explicit MoveHistory(const BoardState &state);
 
-  const int &get_history_score(const Move &move, Color turn) noexcept;
+  // the butterfly history of the move combined with how well it followed the previous moves
+  int get_quiet_history_score(const Move &move, Color turn, const Continuations &continuations) noexcept;
+
+  ContinuationEntry *get_continuation_entry(const Move &move);
+
+  // how often capturing this piece type on the move's to square with the moving piece caused a beta cutoff
+  int get_capture_history_score(const Move &move) noexcept;
 
   std::array<Move, 2> &get_killers(int ply);
 
@@ -19,20 +32,57 @@ class MoveHistory {
 
   void update_counter_move(const Move &prev_move, const Move &counter);
 
-  void update_move_history(const Move &move, List<Move, kMaxMoves>& quiet_non_cutoffs, Color turn, int depth);
+  void update_move_history(const Move &move,
+                           List<Move, kMaxMoves> &quiet_non_cutoffs,
+                           Color turn,
+                           int depth,
+                           const Continuations &continuations);
 
-  void decay_move_history();
+  // rewards the best move if it's a capture, and penalizes the captures searched before it that didn't cause a cutoff
+  void update_capture_history(const Move &best_move, List<Move, kMaxMoves> &capture_non_cutoffs, int depth);
+
+  // scales the history scores down, so a new search still starts from what earlier ones learned but adapts to its
+  // position quickly
+  void age();
+
+  void clear();
 
   void clear_killers(int ply);
 
  private:
-  void penalize_move_history(List<Move, kMaxMoves>& moves, Color turn, int depth);
+  void update_quiet_history(const Move &move, Color turn, int bonus, const Continuations &continuations);
+
+  int &capture_history_entry(const Move &move);
 
  private:
   const BoardState &state_;
   std::array<std::array<Move, 2>, kMaxPlyFromRoot> killer_moves_;
   std::array<std::array<Move, Square::kSquareCount>, Square::kSquareCount> counter_moves_;
   std::array<std::array<std::array<int, Square::kSquareCount>, Square::kSquareCount>, 2> butterfly_history_;
+  // indexed by the color, piece and to square of the capture, and the type of the captured piece
+  std::array<std::array<std::array<std::array<int, PieceType::kNumTypes>, Square::kSquareCount>, PieceType::kNumTypes>, 2>
+      capture_history_;
+  // indexed by the color, piece and to square of the previous move, kept on the heap since it's over a megabyte
+  std::vector<std::array<std::array<ContinuationEntry, Square::kSquareCount>, PieceType::kNumTypes>>
+      continuation_history_;
+};
+
+// tracks how far the search result has been from the static evaluation in positions with the same pawn structure, so
+// the static evaluation's systematic errors can be corrected before it's used for pruning
+class CorrectionHistory {
+ public:
+  CorrectionHistory();
+
+  [[nodiscard]] int correct_static_eval(const BoardState &state, int static_eval) const;
+
+  void update(const BoardState &state, int depth, int search_score, int static_eval);
+
+  void clear();
+
+ private:
+  static constexpr int kNumEntries = 16384;
+
+  std::array<std::array<int, kNumEntries>, 2> pawn_corrections_;
 };
 
 #endif  // INTEGRAL_HISTORY_H
\ No newline at end of file
@@ -5,12 +5,42 @@
 #include <windows.h>
 #endif
 
-int main() {
+// the cpu dispatching build compiles the engine once per x86-64 level, giving each copy its own entry point that
+// src/dispatch/main.cpp picks from
+#ifndef INTEGRAL_ENTRY_POINT
+#define INTEGRAL_ENTRY_POINT main
+#endif
+
+int INTEGRAL_ENTRY_POINT(int argc, char **argv) {
 #ifdef WIN32
   SetConsoleOutputCP(CP_UTF8);
 #endif
 
+  uci::initialize();
+
+  // run the bench and exit when invoked as "integral bench [profile]"
+  if (argc > 1 && std::string(argv[1]) == "bench") {
+    std::stringstream bench_args;
+    for (int i = 2; i < argc; i++) {
+      bench_args << argv[i] << ' ';
+    }
+
+    Board board;
+    return uci::bench(board, bench_args) ? 0 : 1;
+  }
+
+  // label a file of positions and exit when invoked as "integral label <input fens> <output file> [threads]"
+  if (argc > 1 && std::string(argv[1]) == "label") {
+    std::stringstream label_args;
+    for (int i = 2; i < argc; i++) {
+      label_args << argv[i] << ' ';
+    }
+
+    return uci::label(label_args) ? 0 : 1;
+  }
+
   print_ascii_logo();
 
   uci::accept_commands();
+  return 0;
 }
\ No newline at end of file
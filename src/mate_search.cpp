@@ -0,0 +1,285 @@
+#include "mate_search.h"
+#include "move_gen.h"
+
+#include <format>
+
+// proof numbers saturate at infinity, a position with an infinite number has been solved
+const int kInfinity = 1 << 30;
+
+// positions are only shared between searches with the same number of attacker moves left, a position that's a mate in
+// 3 with three moves left is not one with two moves left
+const U64 kMovesLeftKey = 0x9E3779B97F4A7C15ULL;
+
+namespace {
+
+int saturating_add(int a, int b) {
+  return static_cast<int>(std::min<long long>(static_cast<long long>(a) + b, kInfinity));
+}
+
+}  // namespace
+
+MateSearch::MateSearch(Board &board, std::size_t table_mb_size)
+    : board_(board),
+      time_config_(),
+      time_mgmt_(time_config_, board),
+      table_size_(table_mb_size * 1024 * 1024 / sizeof(Entry)),
+      table_(),
+      stopped_(false) {}
+
+MateSearch::ProofNumbers MateSearch::probe(U64 key, int moves_left) const {
+  key ^= kMovesLeftKey * moves_left;
+
+  const auto &entry = table_[key % table_.size()];
+  if (entry.key == key) {
+    return entry.numbers;
+  }
+
+  // nothing is known about the position yet, so it's assumed to be as easy to prove as to disprove
+  return {1, 1};
+}
+
+void MateSearch::save(U64 key, int moves_left, const ProofNumbers &numbers) {
+  key ^= kMovesLeftKey * moves_left;
+  table_[key % table_.size()] = {key, numbers};
+}
+
+MateSearch::ProofNumbers MateSearch::expand(int ply, int moves_left, int phi_threshold, int delta_threshold) {
+  constexpr ProofNumbers kGoalReached = {0, kInfinity};
+  constexpr ProofNumbers kGoalMissed = {kInfinity, 0};
+
+  time_mgmt_.update_nodes_searched();
+  if (time_mgmt_.times_up()) {
+    stopped_ = true;
+  }
+
+  // a draw saves the defender, since repetitions depend on the path they aren't saved
+  const bool attacker_to_move = ply % 2 == 0;
+  if (ply > 0 && board_.is_draw(ply)) {
+    return attacker_to_move ? kGoalMissed : kGoalReached;
+  }
+
+  const auto &state = board_.get_state();
+  const U64 key = state.zobrist_key;
+
+  // out of moves to mate in
+  if (attacker_to_move && moves_left == 0) {
+    save(key, moves_left, kGoalMissed);
+    return kGoalMissed;
+  }
+
+  struct Child {
+    Move move;
+    ProofNumbers numbers;
+  };
+
+  // the attacker's last move has to mate, so it has to be a check
+  const bool only_checks = attacker_to_move && moves_left == 1;
+  const int child_moves_left = attacker_to_move ? moves_left - 1 : moves_left;
+
+  List<Child, kMaxMoves> children;
+  auto moves = move_gen::moves(MoveType::kAll, board_);
+  for (int i = 0; i < moves.size(); i++) {
+    const auto &move = moves[i];
+    if (!board_.is_move_legal(move)) {
+      continue;
+    }
+
+    // when the attacker has no moves left after this defence, it only matters whether the defender has a move at all
+    if (!attacker_to_move && moves_left == 0) {
+      save(key, moves_left, kGoalReached);
+      return kGoalReached;
+    }
+
+    // the exact key of the position after the move is needed, so the move is made
+    board_.make_move(move);
+    const bool gives_check = board_.get_state().checkers != 0;
+    const U64 child_key = board_.get_state().zobrist_key;
+    board_.undo_move();
+
+    if (only_checks && !gives_check) {
+      continue;
+    }
+
+    children.push({move, probe(child_key, child_moves_left)});
+  }
+
+  // checkmated, stalemated, or the attacker has no check left to mate with
+  if (children.empty()) {
+    const bool defender_stalemated = !attacker_to_move && !state.checkers;
+    const auto numbers = defender_stalemated ? kGoalReached : kGoalMissed;
+    save(key, moves_left, numbers);
+    return numbers;
+  }
+
+  // the numbers of the children are tracked here rather than read back from the table, so an overwritten entry can't
+  // make the search revisit the same child forever
+  ProofNumbers numbers;
+  while (true) {
+    // a position is proven as soon as one move reaches the goal, and disproven only once all of them miss it
+    numbers = {kInfinity, 0};
+    int best_child = 0, second_best_delta = kInfinity;
+    for (int i = 0; i < children.size(); i++) {
+      const auto &child_numbers = children[i].numbers;
+      numbers.delta = saturating_add(numbers.delta, child_numbers.phi);
+
+      if (child_numbers.delta < numbers.phi) {
+        second_best_delta = numbers.phi;
+        numbers.phi = child_numbers.delta;
+        best_child = i;
+      } else if (child_numbers.delta < second_best_delta) {
+        second_best_delta = child_numbers.delta;
+      }
+    }
+
+    if (numbers.phi >= phi_threshold || numbers.delta >= delta_threshold || stopped_) {
+      break;
+    }
+
+    // the best child is searched until it's no longer the best, or its parent would pass one of its thresholds
+    auto &child = children[best_child];
+    // the thresholds never exceed infinity, or a solved child could never reach them
+    const int child_phi_threshold = saturating_add(delta_threshold - numbers.delta, child.numbers.phi);
+    const int child_delta_threshold = std::min(phi_threshold, saturating_add(second_best_delta, 1));
+
+    board_.make_move(child.move);
+    child.numbers = expand(ply + 1, child_moves_left, child_phi_threshold, child_delta_threshold);
+    board_.undo_move();
+  }
+
+  if (!stopped_) {
+    save(key, moves_left, numbers);
+  }
+  return numbers;
+}
+
+PVLine MateSearch::extract_pv(int moves_left) {
+  PVLine pv_line;
+
+  // the attacker plays a move that's proven to mate, the defender any move, since they all lose
+  int ply = 0;
+  while (true) {
+    const bool attacker_to_move = ply % 2 == 0;
+    if (attacker_to_move && moves_left == 0) {
+      break;
+    }
+
+    const int child_moves_left = attacker_to_move ? moves_left - 1 : moves_left;
+
+    Move next_move = Move::null_move();
+    auto moves = move_gen::moves(MoveType::kAll, board_);
+    for (int i = 0; i < moves.size() && next_move.is_null(); i++) {
+      if (!board_.is_move_legal(moves[i])) {
+        continue;
+      }
+
+      board_.make_move(moves[i]);
+      const auto numbers = probe(board_.get_state().zobrist_key, child_moves_left);
+      board_.undo_move();
+
+      // the position after the move is lost for the side that moves into it
+      const bool proven = attacker_to_move ? numbers.delta == 0 && numbers.phi == kInfinity
+                                           : numbers.phi == 0 && numbers.delta == kInfinity;
+      if (proven) {
+        next_move = moves[i];
+      }
+    }
+
+    if (next_move.is_null()) {
+      break;
+    }
+
+    pv_line.push(next_move);
+    board_.make_move(next_move);
+
+    moves_left = child_moves_left;
+    ply++;
+  }
+
+  for (int i = 0; i < ply; i++) {
+    board_.undo_move();
+  }
+
+  return pv_line;
+}
+
+void MateSearch::save_pv_bounds(PVLine &pv_line, int mate_in) {
+  auto &transpo = board_.get_transpo_table();
+
+  // the attacker mates at the latest on this ply, but the pv's defence isn't necessarily the longest one, so the
+  // attacker's score is only known to be at least this mate, and the defender's at most its negation
+  const int mate_ply = mate_in * 2 - 1;
+
+  for (int ply = 0; ply < static_cast<int>(pv_line.length()); ply++) {
+    const bool attacker_to_move = ply % 2 == 0;
+
+    TranspositionTable::Entry entry;
+    entry.key = board_.get_state().zobrist_key;
+    entry.depth = kMaxSearchDepth;
+    entry.move = pv_line[ply];
+    entry.score = attacker_to_move ? eval::kMateScore - mate_ply : -eval::kMateScore + mate_ply;
+    entry.flag = attacker_to_move ? TranspositionTable::Entry::kLowerBound : TranspositionTable::Entry::kUpperBound;
+    transpo.save(board_.get_state().zobrist_key, entry, ply);
+
+    board_.make_move(pv_line[ply]);
+  }
+
+  for (int ply = 0; ply < static_cast<int>(pv_line.length()); ply++) {
+    board_.undo_move();
+  }
+}
+
+MateSearch::Result MateSearch::go(int max_moves, const TimeManagement::Config &time_config) {
+  Result result;
+  if (table_.empty()) {
+    table_.resize(table_size_);
+  }
+
+  // what earlier searches proved still holds, only their limits and whether they were stopped don't carry over
+  time_config_ = time_config;
+  stopped_ = false;
+  time_mgmt_.start();
+
+  // the shorter mates are proven first, so the first mate found is the shortest one, and proving a long mate doesn't
+  // cost much more than the shorter searches before it
+  for (int mate_in = 1; mate_in <= std::min(max_moves, kMaxPlyFromRoot / 2); mate_in++) {
+    const auto numbers = expand(0, mate_in, kInfinity, kInfinity);
+    if (stopped_) {
+      break;
+    }
+
+    const bool proven = numbers.phi == 0;
+    if (!proven) {
+      std::cout << std::format("info depth {} nodes {} nps {} time {}",
+                               mate_in * 2 - 1,
+                               time_mgmt_.get_nodes_searched(),
+                               time_mgmt_.nodes_per_second(),
+                               time_mgmt_.time_elapsed()) << std::endl;
+      continue;
+    }
+
+    result.pv_line = extract_pv(mate_in);
+    result.best_move = result.pv_line.length() ? result.pv_line[0] : Move::null_move();
+    result.mate_in = mate_in;
+    save_pv_bounds(result.pv_line, mate_in);
+
+    std::cout << std::format("info depth {} score mate {} nodes {} nps {} time {} pv {}",
+                             mate_in * 2 - 1,
+                             mate_in,
+                             time_mgmt_.get_nodes_searched(),
+                             time_mgmt_.nodes_per_second(),
+                             time_mgmt_.time_elapsed(),
+                             result.pv_line.to_string()) << std::endl;
+    break;
+  }
+
+  time_mgmt_.stop();
+  return result;
+}
+
+long long MateSearch::get_nodes_searched() const {
+  return time_mgmt_.get_nodes_searched();
+}
+
+long long MateSearch::time_elapsed() const {
+  return time_mgmt_.time_elapsed();
+}
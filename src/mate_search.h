@@ -0,0 +1,75 @@
+#ifndef INTEGRAL_MATE_SEARCH_H_
+#define INTEGRAL_MATE_SEARCH_H_
+
+#include "board.h"
+#include "search.h"
+#include "time_mgmt.h"
+
+#include <vector>
+
+// proves forced mates with a depth-first proof-number search (df-pn)
+// instead of searching every move to a fixed depth, it always expands the move that looks cheapest to prove (or
+// disprove), which finds long, narrow mating lines far faster than alpha-beta
+class MateSearch {
+ public:
+  struct Result {
+    Move best_move;
+    PVLine pv_line;
+    // the length of the shortest mate found in moves, 0 if no mate was proven
+    int mate_in;
+
+    Result() : best_move(Move::null_move()), mate_in(0) {}
+  };
+
+  // the proof numbers are kept in a table of their own, sized like the transposition table
+  // the table is only allocated by the first search, and kept for the ones after it
+  MateSearch(Board &board, std::size_t table_mb_size);
+
+  // looks for a mate of the side to move in up to max_moves moves within the config's limits, trying the shorter mates
+  // first
+  Result go(int max_moves, const TimeManagement::Config &time_config);
+
+  [[nodiscard]] long long get_nodes_searched() const;
+
+  [[nodiscard]] long long time_elapsed() const;
+
+ private:
+  // phi and delta are the proof and disproof numbers from the point of view of the side to move: phi is the least
+  // number of positions that must be solved to prove the side to move reaches its goal (mating as the attacker, not
+  // being mated as the defender), delta is the same for proving it doesn't
+  struct ProofNumbers {
+    int phi;
+    int delta;
+  };
+
+  struct Entry {
+    U64 key;
+    ProofNumbers numbers;
+  };
+
+  // expands the position until its proof numbers reach either threshold
+  // moves_left is how many moves the attacker has left to mate in
+  ProofNumbers expand(int ply, int moves_left, int phi_threshold, int delta_threshold);
+
+  // the proof numbers of a position with moves_left attacker moves to go, as far as they're known
+  [[nodiscard]] ProofNumbers probe(U64 key, int moves_left) const;
+
+  void save(U64 key, int moves_left, const ProofNumbers &numbers);
+
+  // follows the proven moves from the root, the attacker's mating moves and any defence against them
+  PVLine extract_pv(int moves_left);
+
+  // stores the bounds that the proof puts on the scores of the pv's positions in the transposition table, so a search
+  // that follows can start from what was proven
+  void save_pv_bounds(PVLine &pv_line, int mate_in);
+
+ private:
+  Board &board_;
+  TimeManagement::Config time_config_;
+  TimeManagement time_mgmt_;
+  std::size_t table_size_;
+  std::vector<Entry> table_;
+  bool stopped_;
+};
+
+#endif // INTEGRAL_MATE_SEARCH_H_
@@ -0,0 +1,143 @@
+#include "material.h"
+#include "bitbase.h"
+#include "eval.h"
+#include "eval_trace.h"
+#include "eval_weights.h"
+
+#include <algorithm>
+
+namespace eval {
+
+namespace {
+
+int distance(Square first, Square second) {
+  return std::max(std::abs(file(first) - file(second)), std::abs(rank(first) - rank(second)));
+}
+
+}
+
+MaterialTable::MaterialTable() : table_(kNumEntries) {}
+
+void MaterialTable::clear() {
+  std::ranges::fill(table_, Entry{});
+}
+
+void MaterialTable::compute_entry(U64 key, Entry &entry) {
+  entry = Entry{};
+  entry.key = key;
+
+  std::array<std::array<int, PieceType::kKing>, 2> counts{};
+  std::array<int, 2> minors{}, non_pawn_pieces{};
+
+  for (const Color color : {Color::kBlack, Color::kWhite}) {
+    for (int piece = PieceType::kPawn; piece < PieceType::kKing; piece++) {
+      counts[color][piece] = material_count(key, color, PieceType(piece));
+    }
+
+    minors[color] = counts[color][PieceType::kKnight] + counts[color][PieceType::kBishop];
+    non_pawn_pieces[color] = minors[color] + counts[color][PieceType::kRook] + counts[color][PieceType::kQueen];
+
+    if (counts[color][PieceType::kBishop] >= 2) {
+      entry.imbalance += color == Color::kWhite ? kBishopPairBonus : -kBishopPairBonus;
+      if (auto trace = active_trace()) trace->bishop_pairs[color]++;
+    }
+  }
+
+  const int pawns = counts[Color::kBlack][PieceType::kPawn] + counts[Color::kWhite][PieceType::kPawn];
+  const int majors = counts[Color::kBlack][PieceType::kRook] + counts[Color::kWhite][PieceType::kRook] +
+                     counts[Color::kBlack][PieceType::kQueen] + counts[Color::kWhite][PieceType::kQueen];
+
+  // a lone king against at most a single minor piece can't be checkmated
+  entry.is_draw = !pawns && !majors && minors[Color::kBlack] <= 1 && minors[Color::kWhite] <= 1 &&
+                  (!minors[Color::kBlack] || !minors[Color::kWhite]);
+
+  for (const Color strong : {Color::kBlack, Color::kWhite}) {
+    const Color weak = flip_color(strong);
+    if (non_pawn_pieces[weak] || counts[weak][PieceType::kPawn]) {
+      continue;
+    }
+
+    if (!non_pawn_pieces[strong] && counts[strong][PieceType::kPawn] == 1) {
+      entry.evaluator = Evaluator::kKPK;
+      entry.strong_side = strong;
+    } else if (!counts[strong][PieceType::kPawn] && non_pawn_pieces[strong] == 2 &&
+               counts[strong][PieceType::kKnight] == 1 && counts[strong][PieceType::kBishop] == 1) {
+      entry.evaluator = Evaluator::kKBNK;
+      entry.strong_side = strong;
+    }
+  }
+
+  // bishops of opposite colors with only pawns besides them are very drawish, whether the bishops really are on
+  // opposite colors is checked in the position
+  if (non_pawn_pieces[Color::kBlack] == 1 && non_pawn_pieces[Color::kWhite] == 1 &&
+      counts[Color::kBlack][PieceType::kBishop] == 1 && counts[Color::kWhite][PieceType::kBishop] == 1) {
+    entry.scaling = Scaling::kOppositeBishops;
+  }
+}
+
+int evaluate_kpk(const MaterialTable::Entry &entry, const BoardState &state) {
+  const Color strong = entry.strong_side, weak = flip_color(strong);
+
+  // view the position as if the strong side is white with the pawn on files a-d
+  auto normalize = [&](Square square) {
+    square = strong == Color::kWhite ? square : Square(square ^ 56);
+    return file(state.pawns(strong).get_lsb_pos()) >= 4 ? Square(square ^ 7) : square;
+  };
+
+  const auto strong_king = normalize(Square(state.king(strong).get_lsb_pos()));
+  const auto weak_king = normalize(Square(state.king(weak).get_lsb_pos()));
+  const auto pawn = normalize(Square(state.pawns(strong).get_lsb_pos()));
+  const Color turn = state.turn == strong ? Color::kWhite : Color::kBlack;
+
+  if (!bitbase::probe_kpk(strong_king, pawn, weak_king, turn)) {
+    return kDrawScore;
+  }
+
+  // prefer pushing the pawn closer to promotion
+  const int score = kKnownWinScore + rank(pawn) * 10;
+  return state.turn == strong ? score : -score;
+}
+
+int evaluate_kbnk(const MaterialTable::Entry &entry, const BoardState &state) {
+  const Color strong = entry.strong_side, weak = flip_color(strong);
+
+  auto weak_king = Square(state.king(weak).get_lsb_pos());
+  const auto strong_king = Square(state.king(strong).get_lsb_pos());
+  const int king_distance = distance(weak_king, strong_king);
+
+  // mate can only be forced in a corner of the bishop's color, a1 and h8 are dark so mirror the board for a light
+  // squared bishop
+  if (state.bishops(strong) & kLightSquares) {
+    weak_king = Square(weak_king ^ 7);
+  }
+
+  const int corner_distance = std::min(distance(weak_king, Square::kA1), distance(weak_king, Square::kH8));
+
+  // drive the weak king towards the right corner, and bring the strong king close to it
+  const int score = kKnownWinScore + (7 - corner_distance) * 20 + (7 - king_distance) * 10;
+  return state.turn == strong ? score : -score;
+}
+
+int evaluate_endgame(const MaterialTable::Entry &entry, const BoardState &state) {
+  switch (entry.evaluator) {
+    case MaterialTable::Evaluator::kKPK:
+      return evaluate_kpk(entry, state);
+    case MaterialTable::Evaluator::kKBNK:
+      return evaluate_kbnk(entry, state);
+    default:
+      return kDrawScore;
+  }
+}
+
+int scale_factor(const MaterialTable::Entry &entry, const BoardState &state) {
+  if (entry.scaling == MaterialTable::Scaling::kOppositeBishops) {
+    const BitBoard bishops = state.bishops();
+    if ((bishops & kLightSquares) && (bishops & kDarkSquares)) {
+      return kScaleNormal / 2;
+    }
+  }
+
+  return kScaleNormal;
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef INTEGRAL_MATERIAL_H_
+#define INTEGRAL_MATERIAL_H_
+
+#include "bitboard.h"
+#include "psqt.h"
+#include "eval_trace.h"
+
+#include <vector>
+
+class BoardState;
+
+namespace eval {
+
+// the material key packs the piece counts of both sides, four bits per color and piece type (kings excluded)
+// adding or removing a piece adds or subtracts its increment, so the key is maintained alongside the board
+constexpr int material_key_shift(Color color, PieceType piece) {
+  const int kPiecesPerColor = 5;
+  return 4 * (static_cast<int>(color) * kPiecesPerColor + static_cast<int>(piece));
+}
+
+constexpr U64 material_key_increment(Color color, PieceType piece) {
+  return piece == PieceType::kKing ? 0ULL : 1ULL << material_key_shift(color, piece);
+}
+
+constexpr int material_count(U64 material_key, Color color, PieceType piece) {
+  return static_cast<int>((material_key >> material_key_shift(color, piece)) & 0xF);
+}
+
+// scale factors are out of kScaleNormal and only apply to the end game score
+const int kScaleNormal = 64;
+
+// a score far above any normal evaluation but below mate scores, for endgames that are known to be won
+const int kKnownWinScore = 10000;
+
+// the evaluation of a material signature that doesn't depend on where the pieces are
+class MaterialTable {
+ public:
+  enum class Evaluator : U8 {
+    kNone,
+    kKPK,
+    kKBNK
+  };
+
+  enum class Scaling : U8 {
+    kNone,
+    kOppositeBishops
+  };
+
+  struct Entry {
+    Entry() : key(0ULL), is_draw(true), evaluator(Evaluator::kNone), scaling(Scaling::kNone), strong_side(Color::kNoColor) {}
+
+    U64 key;
+    // positive for white
+    PackedScore imbalance;
+    // neither side has enough material left to checkmate
+    bool is_draw;
+    // an evaluator that replaces the regular evaluation for this material
+    Evaluator evaluator;
+    // a scale factor that depends on the position, applied to the regular evaluation
+    Scaling scaling;
+    // the side the specialised evaluator is for
+    Color strong_side;
+  };
+
+  static constexpr int kIndexBits = 13;
+  static constexpr std::size_t kNumEntries = 1 << kIndexBits;
+
+  MaterialTable();
+
+  void clear();
+
+  // returns the entry for the material key, computing it if it isn't cached
+  // an empty table already holds the entry of a lone king versus a lone king, since its key is zero
+  [[nodiscard]] inline const Entry &probe(const U64 &key) {
+    // the counts only occupy the low bits of each nibble, so spread them over the index with a multiplicative hash
+    auto &entry = table_[(key * 0x9E3779B97F4A7C15ULL) >> (64 - kIndexBits)];
+    if (entry.key != key || kTracingEnabled) {
+      compute_entry(key, entry);
+    }
+    return entry;
+  }
+
+ private:
+  static void compute_entry(U64 key, Entry &entry);
+
+ private:
+  std::vector<Entry> table_;
+};
+
+// evaluates the position with the entry's specialised evaluator, from the perspective of the side to move
+[[nodiscard]] int evaluate_endgame(const MaterialTable::Entry &entry, const BoardState &state);
+
+// the scale factor for the end game score of the position
+[[nodiscard]] int scale_factor(const MaterialTable::Entry &entry, const BoardState &state);
+
+}
+
+#endif // INTEGRAL_MATERIAL_H_
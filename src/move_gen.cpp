@@ -466,6 +466,100 @@ List<Move, kMaxMoves> moves(MoveType move_type, Board &board) {
   return move_list;
 }
 
+List<Move, kMaxMoves> quiet_checks(Board &board) {
+  List<Move, kMaxMoves> move_list;
+
+  auto &state = board.get_state();
+  const Color us = state.turn;
+  const Color them = flip_color(us);
+
+  const BitBoard occupied = state.occupied();
+  const BitBoard &our_pieces = state.occupied(us);
+  const BitBoard empty = ~occupied;
+
+  const auto king_square = Square(state.king(them).get_lsb_pos());
+
+  // the squares each piece type gives a direct check from
+  std::array<BitBoard, PieceType::kNumTypes> check_squares;
+  check_squares[PieceType::kPawn] = pawn_attacks(king_square, state, them);
+  check_squares[PieceType::kKnight] = knight_moves(king_square);
+  check_squares[PieceType::kBishop] = bishop_moves(king_square, occupied);
+  check_squares[PieceType::kRook] = rook_moves(king_square, occupied);
+  check_squares[PieceType::kQueen] = check_squares[PieceType::kBishop] | check_squares[PieceType::kRook];
+  check_squares[PieceType::kKing] = 0;
+
+  // our pieces that are the only piece between one of our sliders and their king, moving one of them off that line
+  // uncovers a check
+  BitBoard discoverers;
+  BitBoard x_raying_pieces = get_sliding_attackers_to(state, king_square, state.occupied(them), us);
+  while (x_raying_pieces) {
+    const BitBoard blockers = our_pieces & ray_between(king_square, Square(x_raying_pieces.pop_lsb()));
+    if (blockers.pop_count() == 1) {
+      discoverers |= blockers;
+    }
+  }
+
+  const auto push_checks = [&](Square from, BitBoard targets) {
+    BitBoard checks = targets & check_squares[state.get_piece_type(from)];
+    if (discoverers.is_set(from)) {
+      checks |= targets & ~ray_intersecting(from, king_square);
+    }
+
+    while (checks) {
+      move_list.push(Move(from, checks.pop_lsb()));
+    }
+  };
+
+  // promotions are tactical, so pushes to the last rank are generated with the captures
+  const BitBoard non_promoting = ~(RankMask::kRank1 | RankMask::kRank8);
+  const int pushed_pawn_distance = us == Color::kWhite ? 8 : -8;
+
+  BitBoard single_pawn_moves = pawn_pushes(us, state) & non_promoting;
+  BitBoard double_pawn_moves = us == Color::kWhite ? shift<kNorth>(single_pawn_moves & RankMask::kRank3)
+                                                   : shift<kSouth>(single_pawn_moves & RankMask::kRank6);
+  double_pawn_moves &= empty;
+
+  while (single_pawn_moves) {
+    const auto to = Square(single_pawn_moves.pop_lsb());
+    push_checks(Square(to - pushed_pawn_distance), BitBoard::from_square(to));
+  }
+
+  while (double_pawn_moves) {
+    const auto to = Square(double_pawn_moves.pop_lsb());
+    push_checks(Square(to - pushed_pawn_distance * 2), BitBoard::from_square(to));
+  }
+
+  BitBoard knights = state.knights(us) & ~state.pinned;
+  while (knights) {
+    const auto from = Square(knights.pop_lsb());
+    push_checks(from, knight_moves(from) & empty);
+  }
+
+  BitBoard bishops = state.bishops(us);
+  while (bishops) {
+    const auto from = Square(bishops.pop_lsb());
+    push_checks(from, bishop_moves(from, occupied) & empty);
+  }
+
+  BitBoard rooks = state.rooks(us);
+  while (rooks) {
+    const auto from = Square(rooks.pop_lsb());
+    push_checks(from, rook_moves(from, occupied) & empty);
+  }
+
+  BitBoard queens = state.queens(us);
+  while (queens) {
+    const auto from = Square(queens.pop_lsb());
+    push_checks(from, (rook_moves(from, occupied) | bishop_moves(from, occupied)) & empty);
+  }
+
+  // the king can only check by discovery
+  const auto our_king_square = Square(state.king(us).get_lsb_pos());
+  push_checks(our_king_square, king_attacks(our_king_square) & empty);
+
+  return move_list;
+}
+
 List<Move, kMaxMoves> filter_moves(List<Move, kMaxMoves> &moves, MoveType type, Board &board) {
   if (type == MoveType::kAll) return moves;
 
@@ -42,6 +42,10 @@ BitBoard ray_intersecting(Square first, Square second);
 
 List<Move, kMaxMoves> moves(MoveType move_type, Board &board);
 
+// generates the non-capturing, non-promoting moves that check the opponent's king, directly or by discovery
+// castling is left out, and the moves are only pseudo-legal
+List<Move, kMaxMoves> quiet_checks(Board &board);
+
 List<Move, kMaxMoves> filter_moves(List<Move, kMaxMoves> &moves, MoveType type, Board &board);
 
 }
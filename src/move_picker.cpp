@@ -26,7 +26,7 @@ Move MovePicker::next() {
 
     auto &state = board_.get_state();
     if (tt_move_ && board_.is_move_pseudo_legal(tt_move_)) {
-      if (type_ != MovePickerType::kQuiescence || tt_move_.is_tactical(state)) {
+      if (type_ == MovePickerType::kSearch || tt_move_.is_tactical(state)) {
         return tt_move_;
       }
     }
@@ -34,7 +34,7 @@ Move MovePicker::next() {
 
   if (stage_ == Stage::kGenerateMoves) {
     stage_ = Stage::kPlayMoves;
-    if (type_ == MovePickerType::kQuiescence) {
+    if (type_ != MovePickerType::kSearch) {
       generate_and_score_moves<MoveType::kTactical>();
     } else {
       generate_and_score_moves<MoveType::kAll>();
@@ -44,12 +44,28 @@ Move MovePicker::next() {
   if (stage_ == Stage::kPlayMoves) {
     if (moves_idx_ < scored_moves_.moves.size()) {
       const auto &move = selection_sort(scored_moves_, moves_idx_);
-      if (type_ == MovePickerType::kQuiescence && scored_moves_.scores[moves_idx_] < 0) {
-        return Move::null_move();
+      if (type_ == MovePickerType::kSearch || scored_moves_.scores[moves_idx_] >= 0) {
+        moves_idx_++;
+        return move;
       }
+    }
+
+    if (type_ != MovePickerType::kQuiescenceChecks) {
+      return Move::null_move();
+    }
+    stage_ = Stage::kGenerateQuietChecks;
+  }
+
+  if (stage_ == Stage::kGenerateQuietChecks) {
+    stage_ = Stage::kQuietChecks;
+    scored_moves_.moves = move_gen::quiet_checks(board_);
+    moves_idx_ = 0;
+  }
 
-      moves_idx_++;
-      return move;
+  // quiet checks are rare enough that they're searched in the order they were generated
+  if (stage_ == Stage::kQuietChecks) {
+    if (moves_idx_ < scored_moves_.moves.size()) {
+      return scored_moves_.moves[moves_idx_++];
     }
   }
 
@@ -106,18 +122,22 @@ int MovePicker::score_move(Move &move) {
     const auto attacker = state.get_piece_type(from);
     const auto victim = state.get_piece_type(to);
 
+    // the capture history breaks ties between captures of about the same value
     const int mvv_lva_score =
         kMVVLVATable[to == state.en_passant && attacker == PieceType::kPawn ? PieceType::kPawn : victim][attacker];
+    const int capture_score = mvv_lva_score * 512 + move_history_.get_capture_history_score(move);
+
     // good captures are searched first, bad captures are searched last
-    if (eval::static_exchange(move, -eval::kSEEPieceScores[PieceType::kPawn], state)) {
-      return kBaseGoodCaptureScore + mvv_lva_score;
+    if (eval::static_exchange(move, -eval::kSEEPieceScores[PieceType::kPawn], state, search_stack_->attacks)) {
+      return kBaseGoodCaptureScore + capture_score;
     } else {
-      return kBaseBadCaptureScore + mvv_lva_score;
+      return kBaseBadCaptureScore + capture_score;
     }
   }
 
   // killer moves are searched next (moves that caused a beta cutoff at this ply)
-  const int kKillerMoveScore = kBaseGoodCaptureScore - 10;
+  // their score stays below any good capture's, whatever its capture history
+  const int kKillerMoveScore = kBaseGoodCaptureScore - 10000;
   const auto &killers = move_history_.get_killers(search_stack_->ply);
   if (killers[0] == move || killers[1] == move) {
     return kKillerMoveScore;
@@ -133,5 +153,17 @@ int MovePicker::score_move(Move &move) {
 
   // order moves that caused a beta cutoff by their own history score
   // the higher the depth this move caused a cutoff the more likely it move will be ordered first
-  return move_history_.get_history_score(move, state.turn);
+  int score = move_history_.get_quiet_history_score(move, state.turn, search_stack_->continuations());
+
+  // moving a piece away from an attack by a lesser piece is usually good, and moving it into one is usually bad
+  const std::array<int, PieceType::kNumTypes> kThreatScores = {0, 4000, 4000, 6000, 8000, 0};
+  const auto piece = state.get_piece_type(from);
+  const BitBoard threats = search_stack_->attacks.threats_by_lesser(state, piece);
+  if (threats.is_set(from) && !threats.is_set(to)) {
+    score += kThreatScores[piece];
+  } else if (!threats.is_set(from) && threats.is_set(to)) {
+    score -= kThreatScores[piece];
+  }
+
+  return score;
 }
\ No newline at end of file
@@ -12,7 +12,9 @@ struct ScoredMoveList {
 
 enum class MovePickerType {
   kSearch,
-  kQuiescence
+  kQuiescence,
+  // tactical moves followed by the quiet moves that give check, for the first ply of quiescence search
+  kQuiescenceChecks
 };
 
 class MovePicker {
@@ -42,6 +44,8 @@ class MovePicker {
     kGenerateQuiets,
     kQuiets,
     kBadCaptures,
+    kGenerateQuietChecks,
+    kQuietChecks,
   };
 
   Board &board_;
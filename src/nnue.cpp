@@ -0,0 +1,274 @@
+#include "nnue.h"
+#include "board.h"
+
+#include <fstream>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef EVALFILE
+// embed the network into the binary, the symbols mark the start and end of the file's bytes
+asm(".section .rodata\n"
+    ".balign 64\n"
+    ".global integral_embedded_network\n"
+    "integral_embedded_network:\n"
+    ".incbin \"" EVALFILE "\"\n"
+    ".global integral_embedded_network_end\n"
+    "integral_embedded_network_end:\n"
+    ".previous\n");
+
+extern "C" const unsigned char integral_embedded_network[];
+extern "C" const unsigned char integral_embedded_network_end[];
+#endif
+
+namespace nnue {
+
+namespace {
+
+Network network;
+bool loaded = false;
+bool enabled = true;
+
+// number of bytes the network takes up on disk (the in-memory struct has padding)
+constexpr std::size_t kNetworkFileSize =
+    sizeof(I16) * (kInputSize * kHiddenSize + kHiddenSize + 2 * kHiddenSize + 1);
+
+bool load_from_bytes(const unsigned char *data, std::size_t size) {
+  if (size != kNetworkFileSize) {
+    return false;
+  }
+
+  const auto read = [&data](void *destination, std::size_t bytes) {
+    std::memcpy(destination, data, bytes);
+    data += bytes;
+  };
+
+  read(network.feature_weights.data(), sizeof(network.feature_weights));
+  read(network.feature_biases.data(), sizeof(network.feature_biases));
+  read(network.output_weights.data(), sizeof(network.output_weights));
+  read(&network.output_bias, sizeof(network.output_bias));
+
+  loaded = true;
+  return true;
+}
+
+// the input is indexed relative to the perspective, so both perspectives share the same weights
+inline int feature_index(Color perspective, Color color, PieceType piece, Square square) {
+  const int relative_color = color != perspective;
+  const int relative_square = perspective == Color::kWhite ? square : square ^ 56;
+  return relative_color * 384 + piece * 64 + relative_square;
+}
+
+inline void add_feature(std::array<I16, kHiddenSize> &values, int feature) {
+  const auto &weights = network.feature_weights[feature];
+  for (int i = 0; i < kHiddenSize; i++) {
+    values[i] += weights[i];
+  }
+}
+
+// computes output = input + sum(added) - sum(removed) in a single pass over the accumulator
+void update_perspective(const std::array<I16, kHiddenSize> &input,
+                        std::array<I16, kHiddenSize> &output,
+                        const std::array<const I16 *, 2> &added,
+                        int num_added,
+                        const std::array<const I16 *, 2> &removed,
+                        int num_removed) {
+#if defined(__AVX512BW__)
+  constexpr int kChunkSize = sizeof(__m512i) / sizeof(I16);
+  for (int i = 0; i < kHiddenSize; i += kChunkSize) {
+    auto value = _mm512_load_si512(&input[i]);
+    for (int j = 0; j < num_added; j++) {
+      value = _mm512_add_epi16(value, _mm512_load_si512(&added[j][i]));
+    }
+    for (int j = 0; j < num_removed; j++) {
+      value = _mm512_sub_epi16(value, _mm512_load_si512(&removed[j][i]));
+    }
+    _mm512_store_si512(&output[i], value);
+  }
+#elif defined(__AVX2__)
+  constexpr int kChunkSize = sizeof(__m256i) / sizeof(I16);
+  for (int i = 0; i < kHiddenSize; i += kChunkSize) {
+    auto value = _mm256_load_si256(reinterpret_cast<const __m256i *>(&input[i]));
+    for (int j = 0; j < num_added; j++) {
+      value = _mm256_add_epi16(value, _mm256_load_si256(reinterpret_cast<const __m256i *>(&added[j][i])));
+    }
+    for (int j = 0; j < num_removed; j++) {
+      value = _mm256_sub_epi16(value, _mm256_load_si256(reinterpret_cast<const __m256i *>(&removed[j][i])));
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i *>(&output[i]), value);
+  }
+#elif defined(__SSE2__)
+  constexpr int kChunkSize = sizeof(__m128i) / sizeof(I16);
+  for (int i = 0; i < kHiddenSize; i += kChunkSize) {
+    auto value = _mm_load_si128(reinterpret_cast<const __m128i *>(&input[i]));
+    for (int j = 0; j < num_added; j++) {
+      value = _mm_add_epi16(value, _mm_load_si128(reinterpret_cast<const __m128i *>(&added[j][i])));
+    }
+    for (int j = 0; j < num_removed; j++) {
+      value = _mm_sub_epi16(value, _mm_load_si128(reinterpret_cast<const __m128i *>(&removed[j][i])));
+    }
+    _mm_store_si128(reinterpret_cast<__m128i *>(&output[i]), value);
+  }
+#else
+  for (int i = 0; i < kHiddenSize; i++) {
+    I16 value = input[i];
+    for (int j = 0; j < num_added; j++) value += added[j][i];
+    for (int j = 0; j < num_removed; j++) value -= removed[j][i];
+    output[i] = value;
+  }
+#endif
+}
+
+// sum of clipped_relu(values) * weights
+inline I32 clipped_relu_dot(const std::array<I16, kHiddenSize> &values, const std::array<I16, kHiddenSize> &weights) {
+#if defined(__AVX512BW__)
+  constexpr int kChunkSize = sizeof(__m512i) / sizeof(I16);
+  const auto zero = _mm512_setzero_si512();
+  const auto max = _mm512_set1_epi16(kQuantizationA);
+
+  auto sum = _mm512_setzero_si512();
+  for (int i = 0; i < kHiddenSize; i += kChunkSize) {
+    auto value = _mm512_load_si512(&values[i]);
+    value = _mm512_min_epi16(_mm512_max_epi16(value, zero), max);
+    const auto weight = _mm512_load_si512(&weights[i]);
+    sum = _mm512_add_epi32(sum, _mm512_madd_epi16(value, weight));
+  }
+
+  return _mm512_reduce_add_epi32(sum);
+#elif defined(__AVX2__)
+  constexpr int kChunkSize = sizeof(__m256i) / sizeof(I16);
+  const auto zero = _mm256_setzero_si256();
+  const auto max = _mm256_set1_epi16(kQuantizationA);
+
+  auto sum = _mm256_setzero_si256();
+  for (int i = 0; i < kHiddenSize; i += kChunkSize) {
+    auto value = _mm256_load_si256(reinterpret_cast<const __m256i *>(&values[i]));
+    value = _mm256_min_epi16(_mm256_max_epi16(value, zero), max);
+    const auto weight = _mm256_load_si256(reinterpret_cast<const __m256i *>(&weights[i]));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(value, weight));
+  }
+
+  // horizontal sum of the eight 32-bit lanes
+  auto sum_128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  sum_128 = _mm_add_epi32(sum_128, _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum_128 = _mm_add_epi32(sum_128, _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum_128);
+#elif defined(__SSE2__)
+  constexpr int kChunkSize = sizeof(__m128i) / sizeof(I16);
+  const auto zero = _mm_setzero_si128();
+  const auto max = _mm_set1_epi16(kQuantizationA);
+
+  auto sum = _mm_setzero_si128();
+  for (int i = 0; i < kHiddenSize; i += kChunkSize) {
+    auto value = _mm_load_si128(reinterpret_cast<const __m128i *>(&values[i]));
+    value = _mm_min_epi16(_mm_max_epi16(value, zero), max);
+    const auto weight = _mm_load_si128(reinterpret_cast<const __m128i *>(&weights[i]));
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(value, weight));
+  }
+
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+#else
+  I32 sum = 0;
+  for (int i = 0; i < kHiddenSize; i++) {
+    sum += std::clamp<I32>(values[i], 0, kQuantizationA) * weights[i];
+  }
+  return sum;
+#endif
+}
+
+}  // namespace
+
+bool load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return load_from_bytes(bytes.data(), bytes.size());
+}
+
+bool load_embedded() {
+#ifdef EVALFILE
+  return load_from_bytes(integral_embedded_network, integral_embedded_network_end - integral_embedded_network);
+#else
+  return false;
+#endif
+}
+
+bool is_loaded() {
+  return loaded;
+}
+
+void set_enabled(bool value) {
+  enabled = value;
+}
+
+bool is_enabled() {
+  return loaded && enabled;
+}
+
+std::string_view simd_name() {
+#if defined(__AVX512BW__)
+  return "avx512";
+#elif defined(__AVX2__)
+  return "avx2";
+#elif defined(__SSE2__)
+  return "sse2";
+#else
+  return "generic";
+#endif
+}
+
+void refresh(const BoardState &state, Accumulator &accumulator) {
+  for (const Color perspective : {Color::kBlack, Color::kWhite}) {
+    auto &values = accumulator.values[perspective];
+    values = network.feature_biases;
+
+    BitBoard pieces = state.occupied();
+    while (pieces) {
+      const auto square = Square(pieces.pop_lsb());
+      add_feature(values,
+                  feature_index(perspective, state.get_piece_color(square), state.get_piece_type(square), square));
+    }
+  }
+}
+
+void update(const Accumulator &parent, Accumulator &child, const FeatureDelta &delta) {
+  for (const Color perspective : {Color::kBlack, Color::kWhite}) {
+    std::array<const I16 *, 2> added{}, removed{};
+    for (int i = 0; i < delta.num_added; i++) {
+      const auto &feature = delta.added[i];
+      added[i] =
+          network.feature_weights[feature_index(perspective, feature.color, feature.piece, feature.square)].data();
+    }
+    for (int i = 0; i < delta.num_removed; i++) {
+      const auto &feature = delta.removed[i];
+      removed[i] =
+          network.feature_weights[feature_index(perspective, feature.color, feature.piece, feature.square)].data();
+    }
+
+    update_perspective(parent.values[perspective],
+                       child.values[perspective],
+                       added,
+                       delta.num_added,
+                       removed,
+                       delta.num_removed);
+  }
+}
+
+int evaluate(const Accumulator &accumulator, Color turn) {
+  I32 output = clipped_relu_dot(accumulator.values[turn], network.output_weights[0]) +
+               clipped_relu_dot(accumulator.values[flip_color(turn)], network.output_weights[1]);
+
+  output += network.output_bias;
+  return output * kEvalScale / (kQuantizationA * kQuantizationB);
+}
+
+}
\ No newline at end of file
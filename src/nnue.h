@@ -0,0 +1,93 @@
+#ifndef INTEGRAL_NNUE_H_
+#define INTEGRAL_NNUE_H_
+
+#include "bitboard.h"
+
+#include <array>
+#include <string>
+
+class BoardState;
+
+// efficiently updatable neural network evaluation
+// architecture: (768 -> 256) x 2 perspectives -> 1, with a clipped relu between the layers
+// the network file is raw little-endian int16 data in the order: feature weights, feature biases, output weights
+// (side to move half first), output bias
+namespace nnue {
+
+const int kInputSize = 768;
+const int kHiddenSize = 256;
+
+// quantization of the feature transformer and output layer, and the scale from network output to centipawns
+const int kQuantizationA = 255;
+const int kQuantizationB = 64;
+const int kEvalScale = 400;
+
+struct alignas(64) Network {
+  std::array<std::array<I16, kHiddenSize>, kInputSize> feature_weights;
+  std::array<I16, kHiddenSize> feature_biases;
+  std::array<std::array<I16, kHiddenSize>, 2> output_weights;
+  I16 output_bias;
+};
+
+// the feature transformer's output from both perspectives, indexed by color
+struct alignas(64) Accumulator {
+  std::array<std::array<I16, kHiddenSize>, 2> values;
+
+  bool operator==(const Accumulator &other) const = default;
+};
+
+// the pieces a move added to and removed from the board, used to update the accumulator incrementally
+// no move changes more than two pieces of each kind (castling moves the king and rook, captures remove two pieces)
+struct FeatureDelta {
+  struct Feature {
+    Color color;
+    PieceType piece;
+    Square square;
+  };
+
+  void add(Color color, PieceType piece, Square square) {
+    added[num_added++] = {color, piece, square};
+  }
+
+  void remove(Color color, PieceType piece, Square square) {
+    removed[num_removed++] = {color, piece, square};
+  }
+
+  void clear() {
+    num_added = num_removed = 0;
+  }
+
+  std::array<Feature, 2> added;
+  std::array<Feature, 2> removed;
+  int num_added = 0;
+  int num_removed = 0;
+};
+
+// loads a network from a file, returns false if the file doesn't exist or has the wrong size
+bool load(const std::string &path);
+
+// loads the network embedded at compile time (cmake -DEVALFILE=<path>), if there is one
+bool load_embedded();
+
+[[nodiscard]] bool is_loaded();
+
+// whether evaluation should use the network, true by default once a network is loaded
+void set_enabled(bool enabled);
+
+[[nodiscard]] bool is_enabled();
+
+// the instruction set the inference was compiled for
+[[nodiscard]] std::string_view simd_name();
+
+// computes the accumulator of a position from scratch
+void refresh(const BoardState &state, Accumulator &accumulator);
+
+// computes the accumulator of a position from its parent's and the pieces the move added/removed
+void update(const Accumulator &parent, Accumulator &child, const FeatureDelta &delta);
+
+// evaluates the position from the perspective of the side to move
+[[nodiscard]] int evaluate(const Accumulator &accumulator, Color turn);
+
+}
+
+#endif // INTEGRAL_NNUE_H_
\ No newline at end of file
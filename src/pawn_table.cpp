@@ -0,0 +1,13 @@
+#include "pawn_table.h"
+
+#include <algorithm>
+
+namespace eval {
+
+PawnTable::PawnTable() : table_(kNumEntries) {}
+
+void PawnTable::clear() {
+  std::ranges::fill(table_, Entry{});
+}
+
+}
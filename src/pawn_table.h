@@ -0,0 +1,37 @@
+#ifndef INTEGRAL_PAWN_TABLE_H_
+#define INTEGRAL_PAWN_TABLE_H_
+
+#include "bitboard.h"
+#include "psqt.h"
+
+namespace eval {
+
+// caches the pawn-structure evaluation by pawn key, pawn structures repeat heavily within the search tree so most
+// nodes only need a probe instead of evaluating every pawn
+class PawnTable {
+ public:
+  struct Entry {
+    Entry() : key(0ULL) {}
+
+    U64 key;
+    // pawn-structure score, positive for white
+    PackedScore score;
+  };
+
+  static constexpr std::size_t kNumEntries = 1 << 14;
+
+  PawnTable();
+
+  void clear();
+
+  [[nodiscard]] inline Entry &probe(const U64 &key) {
+    return table_[key & (kNumEntries - 1)];
+  }
+
+ private:
+  std::vector<Entry> table_;
+};
+
+}
+
+#endif // INTEGRAL_PAWN_TABLE_H_
@@ -0,0 +1,143 @@
+#include "perf_counters.h"
+
+#include <format>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+namespace {
+
+struct EventConfig {
+  U32 type;
+  U64 config;
+};
+
+constexpr U64 cache_event(U64 cache, U64 op, U64 result) {
+  return cache | (op << 8) | (result << 16);
+}
+
+const std::array<EventConfig, PerfCounters::kNumEvents> kEventConfigs = {{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE,
+     cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE,
+     cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+}};
+
+int open_event(const EventConfig &event_config) {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.type = event_config.type;
+  attr.config = event_config.config;
+  attr.disabled = 1;
+  // only count user space, which is usually all that's permitted in containers anyway
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // the counters may be multiplexed if the pmu doesn't have enough of them, so we scale by the time they ran
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  // measure the calling (search) thread on any cpu
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+}  // namespace
+#endif
+
+PerfCounters::PerfCounters() : values_({}) {
+  fds_.fill(-1);
+
+#ifdef __linux__
+  for (int event = 0; event < kNumEvents; event++) {
+    fds_[event] = open_event(kEventConfigs[event]);
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (const int fd : fds_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+void PerfCounters::start() {
+#ifdef __linux__
+  for (const int fd : fds_) {
+    if (fd != -1) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounters::stop() {
+#ifdef __linux__
+  for (int event = 0; event < kNumEvents; event++) {
+    const int fd = fds_[event];
+    if (fd == -1) {
+      continue;
+    }
+
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    // value, time enabled, time running
+    std::array<U64, 3> data{};
+    if (read(fd, data.data(), sizeof(data)) != sizeof(data) || data[2] == 0) {
+      continue;
+    }
+
+    values_[event] += static_cast<U64>(static_cast<double>(data[0]) * data[1] / data[2]);
+  }
+#endif
+}
+
+bool PerfCounters::available(Event event) const {
+  return fds_[event] != -1;
+}
+
+U64 PerfCounters::get(Event event) const {
+  return values_[event];
+}
+
+void PerfCounters::print(long long nodes) const {
+  bool any_available = false;
+
+  std::string counters;
+  for (int event = 0; event < kNumEvents; event++) {
+    if (!available(Event(event))) {
+      counters += std::format(" {} n/a", kEventNames[event]);
+      continue;
+    }
+
+    any_available = true;
+    counters += std::format(" {} {} ({:.2f}/node)",
+                            kEventNames[event],
+                            values_[event],
+                            static_cast<double>(values_[event]) / std::max(nodes, 1LL));
+  }
+
+  if (!any_available) {
+    std::cout << "info string perf counters unavailable (needs linux and perf_event_paranoid <= 2)" << std::endl;
+    return;
+  }
+
+  std::cout << std::format("info string perf{}", counters) << std::endl;
+
+  if (available(kCycles) && available(kInstructions) && values_[kCycles] > 0) {
+    std::cout << std::format("info string perf ipc {:.2f}",
+                             static_cast<double>(values_[kInstructions]) / values_[kCycles]) << std::endl;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef INTEGRAL_PERF_COUNTERS_H_
+#define INTEGRAL_PERF_COUNTERS_H_
+
+#include "types.h"
+
+#include <array>
+#include <string_view>
+
+// reads hardware performance counters around a search through linux's perf_event_open
+// counters that can't be opened (non-linux builds, containers, perf_event_paranoid) are reported as unavailable
+class PerfCounters {
+ public:
+  enum Event : int {
+    kCycles,
+    kInstructions,
+    kL1DataMisses,
+    kLastLevelCacheMisses,
+    kBranchMisses,
+    kDataTLBMisses,
+    kNumEvents
+  };
+
+  PerfCounters();
+
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  // counts accumulate over every start/stop pair, so several searches can be measured together
+  void start();
+
+  void stop();
+
+  [[nodiscard]] bool available(Event event) const;
+
+  [[nodiscard]] U64 get(Event event) const;
+
+  // prints the counters and their per-node ratios as uci info strings
+  void print(long long nodes) const;
+
+ private:
+  static constexpr std::array<std::string_view, kNumEvents> kEventNames = {
+      "cycles",
+      "instructions",
+      "l1d-misses",
+      "llc-misses",
+      "branch-misses",
+      "dtlb-misses",
+  };
+
+  std::array<int, kNumEvents> fds_;
+  std::array<U64, kNumEvents> values_;
+};
+
+#endif // INTEGRAL_PERF_COUNTERS_H_
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef INTEGRAL_PSQT_H_
+#define INTEGRAL_PSQT_H_
+
+#include "bitboard.h"
+
+#include <array>
+
+namespace eval {
+
+// a middle game and an end game score packed into a single integer, so that both can be updated with one addition
+// the end game score lives in the upper 16 bits and the middle game score in the lower 16 bits
+class PackedScore {
+ public:
+  constexpr PackedScore() : score_(0) {}
+
+  constexpr PackedScore(int middle_game, int end_game)
+      : score_(static_cast<int>(static_cast<U32>(end_game) << 16) + middle_game) {}
+
+  [[nodiscard]] constexpr inline int middle_game() const {
+    return static_cast<std::int16_t>(static_cast<U16>(score_));
+  }
+
+  [[nodiscard]] constexpr inline int end_game() const {
+    // round up when the middle game score is negative, since it borrowed from the end game half
+    return static_cast<std::int16_t>(static_cast<U16>(static_cast<U32>(score_ + 0x8000) >> 16));
+  }
+
+  constexpr inline PackedScore &operator+=(const PackedScore &other) {
+    score_ += other.score_;
+    return *this;
+  }
+
+  constexpr inline PackedScore &operator-=(const PackedScore &other) {
+    score_ -= other.score_;
+    return *this;
+  }
+
+  constexpr inline PackedScore operator-() const {
+    return from_raw(-score_);
+  }
+
+  constexpr inline bool operator==(const PackedScore &other) const {
+    return score_ == other.score_;
+  }
+
+ private:
+  static constexpr PackedScore from_raw(int score) {
+    PackedScore packed;
+    packed.score_ = score;
+    return packed;
+  }
+
+  int score_;
+};
+
+const int kMaxGamePhase = 24;
+
+const std::array<int, PieceType::kNumTypes + 1> kGamePhaseIncrements = {0, 1, 1, 2, 4, 0, 0};
+
+// material and piece-square score of a piece on a square, positive for white and negative for black
+extern std::array<std::array<std::array<PackedScore, Square::kSquareCount>, PieceType::kNumTypes>, 2> piece_square_table;
+
+// builds the piece-square table from the evaluation weights, must be called before any board is set up
+void init_tables();
+
+}
+
+#endif // INTEGRAL_PSQT_H_
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "search.h"
+#include "allocation_tracker.h"
 #include "move_gen.h"
 #include "transpo.h"
 #include "move_picker.h"
 #include "time_mgmt.h"
+#include "tracer.h"
 
 #include <iomanip>
 #include <format>
@@ -11,8 +13,16 @@ Search::Search(TimeManagement::Config &time_config, Board &board)
     : board_(board),
       time_mgmt_(time_config, board),
       stack_({}),
+      pv_table_(),
+      root_moves_(),
+      pv_index_(0),
+      stats_(),
       sel_depth_(0),
-      move_history_(board_.get_state()) {}
+      move_history_(board_.get_state()),
+      correction_history_() {
+  // the list is refilled for every search, it never needs to grow once it has room for every move
+  root_moves_.reserve(kMaxMoves);
+}
 
 std::array<std::array<int, kMaxPlyFromRoot>, kMaxSearchDepth + 1> Search::kLateMoveReductionTable{{}};
 
@@ -29,7 +39,7 @@ void Search::init_tables() {
 }
 
 template<NodeType node_type>
-int Search::quiesce(int ply, int alpha, int beta) {
+int Search::quiesce(int ply, int alpha, int beta, int depth) {
   // check for repetitions of this position and the fifty-move rule
   if (board_.is_draw(ply)) {
     return 0;
@@ -39,6 +49,8 @@ int Search::quiesce(int ply, int alpha, int beta) {
   const auto &state = board_.get_state();
   auto &transpo = board_.get_transpo_table();
 
+  stats_.increment(SearchStats::kQuiescenceNodes);
+
   // pv nodes are nodes that fall inside the [alpha, beta] window
   // these nodes are searched in their entirety, as they're where the most "sensible" moves belong
   constexpr bool in_pv_node = node_type != NodeType::kNonPV;
@@ -47,59 +59,94 @@ int Search::quiesce(int ply, int alpha, int beta) {
   const auto &tt_entry = transpo.probe(state.zobrist_key);
   const bool tt_hit = tt_entry.compare_key(state.zobrist_key);
   const Move tt_move = tt_hit ? tt_entry.move : Move::null_move();
+
+  stats_.increment(SearchStats::kTTProbesQuiescence);
+  if (tt_hit) {
+    stats_.increment(SearchStats::kTTHitsQuiescence);
+  }
+
   if (!in_pv_node && tt_hit && tt_entry.score != kScoreNone &&
       (tt_entry.flag == TranspositionTable::Entry::kExact ||
        (tt_entry.flag == TranspositionTable::Entry::kLowerBound && tt_entry.score >= beta) ||
        (tt_entry.flag == TranspositionTable::Entry::kUpperBound && tt_entry.score <= alpha))) {
+    stats_.increment(SearchStats::kTTCutoffsQuiescence);
     return transpo.correct_score(tt_entry.score, ply);
   }
 
-  const int static_eval = tt_hit ? tt_entry.score : eval::evaluate(state);
-  if (ply >= kMaxPlyFromRoot) {
+  // a mate score from the table is a bound on the search result at another ply, not an evaluation of this position
+  const bool tt_has_eval = tt_hit && !eval::is_mate_score(tt_entry.score);
+  const int static_eval = tt_has_eval ? tt_entry.score : eval::evaluate(board_);
+  if (ply >= kMaxPlyFromRoot - 1) {
     return static_eval;
   }
 
-  if (static_eval >= beta) {
+  // when in check, standing pat isn't an option since the position might be lost, so every evasion is searched
+  const bool in_check = state.checkers != 0;
+  if (!in_check && static_eval >= beta) {
     return static_eval;
   }
 
   Move best_move = Move::null_move();
-  int best_score = static_eval;
+  int best_score = in_check ? -eval::kMateScore + ply : static_eval;
   int moves_tried = 0;
 
-  alpha = std::max(alpha, static_eval);
+  alpha = std::max(alpha, best_score);
   const int original_alpha = alpha;
 
-  MovePicker move_picker(MovePickerType::kQuiescence, board_, tt_move, move_history_, &stack_[ply]);
+  auto &attacks = stack_[ply].attacks;
+  attacks.reset();
+  stack_[ply].ply = ply;
+
+  // quiet checks are only worth their cost at the first ply, deeper plies would chase long checking sequences
+  const auto picker_type = in_check     ? MovePickerType::kSearch
+                           : depth == 0 ? MovePickerType::kQuiescenceChecks
+                                        : MovePickerType::kQuiescence;
+  MovePicker move_picker(picker_type, board_, tt_move, move_history_, &stack_[ply]);
   Move move = Move::null_move();
   while (move = move_picker.next()) {
     // load the transposition table entry for this move in the background
     transpo.prefetch(board_.key_after(move));
 
-    if (!board_.is_move_legal(move)) {
+    if (!board_.is_move_legal(move, attacks)) {
       continue;
     }
 
+    // quiet checks and evasions are only searched if they don't lose material, unless we could be getting mated
+    // captures that have rarely caused cutoffs must win material outright
+    if (best_score > -eval::kMateScore + kMaxPlyFromRoot) {
+      const int see_threshold = move.is_capture(state) ? -move_history_.get_capture_history_score(move) / 32 : 0;
+      if ((!move.is_tactical(state) || see_threshold > 0) &&
+          !eval::static_exchange(move, see_threshold, state, attacks)) {
+        continue;
+      }
+    }
+
     time_mgmt_.update_nodes_searched();
+    stack_[ply].continuation_entry = move_history_.get_continuation_entry(move);
     board_.make_move(move);
 
+    // clear the child pv so the pv for this node is accurate
+    if (in_pv_node) {
+      pv_table_.clear(ply + 1);
+    }
+
     // principal variation search (pvs)
     // search the first move with a normal alpha-beta window
     int score;
     if (in_pv_node) {
       if (moves_tried == 0) {
-        score = -quiesce<pv_node_type>(ply + 1, -beta, -alpha);
+        score = -quiesce<pv_node_type>(ply + 1, -beta, -alpha, depth - 1);
       } else {
         // null window search for a quick refutation or indication of a potentially good move
-        score = -quiesce<NodeType::kNonPV>(ply + 1, -alpha - 1, -alpha);
+        score = -quiesce<NodeType::kNonPV>(ply + 1, -alpha - 1, -alpha, depth - 1);
 
         // if the move looks promising from null window search, re-search to obtain a more accurate score
-        if (score > alpha && in_pv_node) {
-          score = -quiesce<pv_node_type>(ply + 1, -beta, -alpha);
+        if (score > alpha) {
+          score = -quiesce<pv_node_type>(ply + 1, -beta, -alpha, depth - 1);
         }
       }
     } else {
-      score = -quiesce<NodeType::kNonPV>(ply + 1, -alpha - 1, -alpha);
+      score = -quiesce<NodeType::kNonPV>(ply + 1, -alpha - 1, -alpha, depth - 1);
     }
 
     board_.undo_move();
@@ -113,6 +160,11 @@ int Search::quiesce(int ply, int alpha, int beta) {
       best_score = score;
       best_move = move;
 
+      // the capture sequence that raised alpha continues the pv
+      if (in_pv_node && score > alpha) {
+        pv_table_.update(ply, move);
+      }
+
       if (score >= beta) {
         break;
       }
@@ -121,11 +173,16 @@ int Search::quiesce(int ply, int alpha, int beta) {
     }
   }
 
-  // we may be in stalemate/checkmate
+  // every evasion was searched, so having none is checkmate
+  if (moves_tried == 0 && in_check) {
+    return -eval::kMateScore + ply;
+  }
+
+  // we may be in stalemate
   if (moves_tried == 0) {
     List<Move, kMaxMoves> moves = move_gen::moves(MoveType::kAll, board_);
     for (int i = 0; i < moves.size(); i++) {
-      if (board_.is_move_legal(moves[i]))
+      if (board_.is_move_legal(moves[i], attacks))
         goto end;
     }
 
@@ -151,20 +208,31 @@ int Search::quiesce(int ply, int alpha, int beta) {
 }
 
 template<NodeType node_type>
-int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
+int Search::search(int depth, int ply, int alpha, int beta) {
+  // pv nodes are nodes that fall inside the [alpha, beta] window
+  // these nodes are searched in their entirety, as they're where the most "sensible" moves belong
+  constexpr bool in_root = node_type == NodeType::kRoot;
+  constexpr bool in_pv_node = node_type != NodeType::kNonPV;
+  constexpr auto pv_node_type = in_pv_node ? NodeType::kPV : NodeType::kNonPV;
+
   // check for repetitions of this position and the fifty-move rule
-  if (board_.is_draw(ply)) {
+  // the root is still searched, a move has to be played even in a drawn position (such as one with insufficient
+  // material)
+  if (!in_root && board_.is_draw(ply)) {
     return 0;
     //return 1 - (time_mgmt_.get_nodes_searched() & 2);
   }
 
   const auto &state = board_.get_state();
 
-  // pv nodes are nodes that fall inside the [alpha, beta] window
-  // these nodes are searched in their entirety, as they're where the most "sensible" moves belong
-  constexpr bool in_root = node_type == NodeType::kRoot;
-  constexpr bool in_pv_node = node_type != NodeType::kNonPV;
-  constexpr auto pv_node_type = in_pv_node ? NodeType::kPV : NodeType::kNonPV;
+  // if we can repeat an earlier position of the search, we can always settle for a draw
+  if (!in_root && alpha < eval::kDrawScore && board_.has_upcoming_repetition(ply)) {
+    stats_.increment(SearchStats::kUpcomingRepetitions);
+    alpha = eval::kDrawScore;
+    if (alpha >= beta) {
+      return alpha;
+    }
+  }
 
   const bool in_check = state.checkers != 0;
   if (in_check) {
@@ -188,6 +256,17 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
   auto &transpo = board_.get_transpo_table();
   const int original_alpha = alpha;
 
+  stats_.increment(SearchStats::kSearchNodes);
+
+  // the stack (and the killers of the next ply) end here, so the position can only be evaluated
+  if (ply >= kMaxPlyFromRoot - 1) [[unlikely]] {
+    return eval::evaluate(board_);
+  }
+
+  // a singular extension search of this position, which searches every move except the tt move
+  const Move excluded_move = stack_[ply].excluded_move;
+  const bool in_singular_search = !excluded_move.is_null();
+
   // probe the transposition table to see if we can:
   // a) return an exact score for this position if it's been evaluated before
   // b) return alpha if this position score indicates a better option us
@@ -195,22 +274,54 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
   const auto &tt_entry = transpo.probe(state.zobrist_key);
   const bool tt_hit = tt_entry.compare_key(state.zobrist_key);
   const Move tt_move = tt_hit ? tt_entry.move : Move::null_move();
-  if (!in_pv_node && tt_hit && tt_entry.depth >= depth && tt_entry.score != kScoreNone &&
+
+  stats_.increment(in_pv_node ? SearchStats::kTTProbesPV : SearchStats::kTTProbesNonPV);
+  if (tt_hit) {
+    stats_.increment(in_pv_node ? SearchStats::kTTHitsPV : SearchStats::kTTHitsNonPV);
+  }
+
+  if (!in_pv_node && !in_singular_search && tt_hit && tt_entry.depth >= depth && tt_entry.score != kScoreNone &&
       (tt_entry.flag == TranspositionTable::Entry::kExact ||
        (tt_entry.flag == TranspositionTable::Entry::kLowerBound && tt_entry.score >= beta) ||
        (tt_entry.flag == TranspositionTable::Entry::kUpperBound && tt_entry.score <= alpha))) {
+    stats_.increment(SearchStats::kTTCutoffsNonPV);
     return transpo.correct_score(tt_entry.score, ply);
   }
 
-  const int static_eval = tt_hit && !in_check ? tt_entry.score : eval::evaluate(state);
-  if (ply >= kMaxPlyFromRoot) [[unlikely]] {
-    return static_eval;
+  // the tt entry can be overwritten by the searches below, so the details needed to test for a singular move are copied
+  // only a lower bound (or exact score) deep enough to be close to this search says the tt move is likely the best one
+  struct {
+    Move move = Move::null_move();
+    int score = kScoreNone;
+  } singular_candidate;
+  if (!in_singular_search && tt_hit && tt_entry.depth >= depth - 3 &&
+      tt_entry.flag != TranspositionTable::Entry::kUpperBound && tt_entry.score != kScoreNone &&
+      !eval::is_mate_score(tt_entry.score)) {
+    singular_candidate.move = tt_move;
+    singular_candidate.score = transpo.correct_score(tt_entry.score, ply);
+  }
+
+  // the raw evaluation is kept to measure its error against the search result, the corrected one is used for pruning
+  // nothing is pruned on the evaluation when in check, so it isn't computed there
+  int raw_eval = kScoreNone, static_eval = kScoreNone;
+  if (!in_check) {
+    raw_eval = eval::evaluate(board_);
+    static_eval = correction_history_.correct_static_eval(state, raw_eval);
+
+    // a tt score is a better estimate than the evaluation only when its bound says the real score lies beyond it
+    if (tt_hit && tt_entry.score != kScoreNone && !eval::is_mate_score(tt_entry.score) &&
+        (tt_entry.flag == TranspositionTable::Entry::kExact ||
+         (tt_entry.flag == TranspositionTable::Entry::kLowerBound && tt_entry.score > static_eval) ||
+         (tt_entry.flag == TranspositionTable::Entry::kUpperBound && tt_entry.score < static_eval))) {
+      static_eval = tt_entry.score;
+    }
   }
 
   sel_depth_ = std::max(sel_depth_, ply);
 
   auto search_stack = &stack_[ply];
   search_stack->ply = ply;
+  search_stack->attacks.reset();
 
   bool improving = false;
   if (!in_check) {
@@ -232,18 +343,20 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
 
   // reverse (static) futility pruning: cutoff if we think the position can't fall below beta anytime soon
   // the margin for this comparison is scaled based on how many ply we have left to search
-  if (depth <= 6 && !in_pv_node && !in_check) {
+  if (depth <= 6 && !in_pv_node && !in_check && !in_singular_search) {
     const int futility_margin = (depth - improving) * 120;
     if (static_eval - futility_margin >= beta) {
+      stats_.increment(SearchStats::kReverseFutilityPrunes);
       return static_eval;
     }
   }
 
   // razoring: when evaluation is far below alpha, we assume only captures can bring us back
   // therefore, drop into quiesce and cut off if we still can't hit/raise alpha
-  if (!in_pv_node && !in_check && alpha < 2000 && static_eval < alpha - 400 * depth) {
+  if (!in_pv_node && !in_check && !in_singular_search && alpha < 2000 && static_eval < alpha - 400 * depth) {
     const int razoring_score = quiesce<pv_node_type>(ply, alpha, beta);
     if (razoring_score <= alpha) {
+      stats_.increment(SearchStats::kRazoringPrunes);
       return razoring_score;
     }
   }
@@ -251,17 +364,19 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
   // null move pruning: forfeit a move to our opponent and perform a shallow search
   // if the search indicates a winning position, it's safe to assume this move too good and
   // the opponent wouldn't have allowed this position to occur, so we prune this branch
-  if (!state.move_played.is_null() && static_eval >= beta && !in_check && !in_pv_node) {
+  if (!state.move_played.is_null() && static_eval >= beta && !in_check && !in_pv_node && !in_singular_search) {
     // nmp is considered unsafe in positions that zugwang is likely to occur
     const bool safe_to_nmp =
         state.knights(state.turn) || state.bishops(state.turn) || state.rooks(state.turn) || state.queens(state.turn);
     if (safe_to_nmp) {
       transpo.prefetch(board_.key_after(Move::null_move()));
 
+      search_stack->continuation_entry = nullptr;
       board_.make_null_move();
+      stats_.increment(SearchStats::kNullMoveSearches);
 
       const int reduction = depth / 4 + 4;
-      const int null_move_score = -search<NodeType::kNonPV>(depth - reduction, ply + 1, -beta, -beta + 1, result);
+      const int null_move_score = -search<NodeType::kNonPV>(depth - reduction, ply + 1, -beta, -beta + 1);
 
       board_.undo_move();
 
@@ -270,57 +385,150 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
       }
 
       if (null_move_score >= beta) {
+        stats_.increment(SearchStats::kNullMovePrunes);
         return null_move_score >= eval::kMateScore - kMaxPlyFromRoot ? beta : null_move_score;
       }
     }
   }
 
+  // probcut: a good capture that beats beta by a wide margin in a shallower search most likely beats beta in a full one
+  // the captures are filtered by SEE and verified with quiescence first, so the reduced search is only paid for the
+  // captures that look like they hold
+  // from depth 5 the reduced search is still at least a ply deep, starting it later saves nodes but plays weaker
+  const int probcut_beta = beta + 200;
+  if (depth >= 5 && !in_pv_node && !in_check && !in_singular_search && !eval::is_mate_score(beta) &&
+      !(tt_entry.compare_key(state.zobrist_key) && tt_entry.depth >= depth - 3 && tt_entry.score != kScoreNone &&
+        transpo.correct_score(tt_entry.score, ply) < probcut_beta)) {
+    MovePicker probcut_picker(MovePickerType::kQuiescence, board_, tt_move, move_history_, search_stack);
+    Move move = Move::null_move();
+    while (move = probcut_picker.next()) {
+      if (!board_.is_move_legal(move, search_stack->attacks) ||
+          !eval::static_exchange(move, probcut_beta - static_eval, state, search_stack->attacks)) {
+        continue;
+      }
+
+      transpo.prefetch(board_.key_after(move));
+      stats_.increment(SearchStats::kProbCutSearches);
+
+      time_mgmt_.update_nodes_searched();
+      search_stack->continuation_entry = move_history_.get_continuation_entry(move);
+      board_.make_move(move);
+
+      int score = -quiesce<NodeType::kNonPV>(ply + 1, -probcut_beta, -probcut_beta + 1);
+      if (score >= probcut_beta) {
+        score = -search<NodeType::kNonPV>(depth - 4, ply + 1, -probcut_beta, -probcut_beta + 1);
+      }
+
+      board_.undo_move();
+
+      if (time_mgmt_.times_up()) {
+        return 0;
+      }
+
+      if (score >= probcut_beta) {
+        stats_.increment(SearchStats::kProbCutPrunes);
+        transpo.save(state.zobrist_key,
+                     TranspositionTable::Entry(state.zobrist_key,
+                                               depth - 3,
+                                               TranspositionTable::Entry::kLowerBound,
+                                               score,
+                                               move),
+                     ply);
+        return score;
+      }
+    }
+  }
+
   move_history_.clear_killers(ply + 1);
 
-  List<Move, kMaxMoves> quiet_non_cutoffs;
+  List<Move, kMaxMoves> quiet_non_cutoffs, capture_non_cutoffs;
   int moves_tried = 0;
 
+  const auto continuations = search_stack->continuations();
+
   Move best_move = Move::null_move();
   int best_score = std::numeric_limits<int>::min();
 
+  // the root searches its own list of moves instead, in the order the previous searches of them left it
   MovePicker move_picker(MovePickerType::kSearch, board_, tt_move, move_history_, search_stack);
+  int root_move_idx = pv_index_;
+  const auto next_move = [&] {
+    if constexpr (in_root) {
+      return root_move_idx < static_cast<int>(root_moves_.size()) ? root_moves_[root_move_idx++].move
+                                                                  : Move::null_move();
+    }
+    return move_picker.next();
+  };
+
   Move move = Move::null_move();
-  while (move = move_picker.next()) {
+  while (move = next_move()) {
     // load the transposition table entry for this move in the background
     transpo.prefetch(board_.key_after(move));
 
-    if (!board_.is_move_legal(move)) {
+    if (move == excluded_move || !board_.is_move_legal(move, search_stack->attacks)) {
       continue;
     }
 
     const bool is_quiet = !move.is_tactical(state);
-
+    const bool is_capture = move.is_capture(state);
+    const int history_score = is_quiet     ? move_history_.get_quiet_history_score(move, state.turn, continuations)
+                              : is_capture ? move_history_.get_capture_history_score(move)
+                                           : 0;
     // no aggressive pruning when we could potentially be checkmated
     if (best_score > -eval::kMateScore + kMaxPlyFromRoot) {
       // static exchange evaluation (SEE) pruning: skip moves that lose too much material
-      const int see_threshold = is_quiet ? -60 * depth : -20 * depth * depth;
-      if (depth <= 8 && moves_tried > 0 && !eval::static_exchange(move, see_threshold, state)) {
+      // captures that have often caused cutoffs here are allowed to lose more
+      const int see_threshold = is_quiet ? -60 * depth : -20 * depth * depth - history_score / 32;
+      if (depth <= 8 && moves_tried > 0 && !eval::static_exchange(move, see_threshold, state, search_stack->attacks)) {
+        stats_.increment(SearchStats::kSEEPrunes);
         continue;
       }
 
       // late move pruning: skip (late) quiet moves if we've already searched the most promising moves
       const int lmp_threshold = (3 + depth * depth) / (2 - improving);
       if (is_quiet && !in_root && moves_tried >= lmp_threshold) {
+        stats_.increment(SearchStats::kLateMovePrunes);
         break;
       }
 
       // futility pruning: skip (futile) quiet moves when there's a really low chance our eval can raise alpha
       if (depth <= 8 && !in_root && !in_check && is_quiet && static_eval + 150 + 100 * depth < alpha &&
           alpha < eval::kMateScore - kMaxPlyFromRoot) {
+        stats_.increment(SearchStats::kFutilityPrunes);
         continue;
       }
 
       // history pruning: skip quiet moves that don't cause as many beta cutoffs
-      if (is_quiet && depth <= 4 && move_history_.get_history_score(move, state.turn) < -1024 * depth) {
+      if (is_quiet && depth <= 4 && history_score < -1024 * depth) {
+        stats_.increment(SearchStats::kHistoryPrunes);
         break;
       }
     }
 
+    // singular extensions: when the tt move fails high by a margin over every other move searched to a reduced depth,
+    // it's the only move keeping this position's score up and deserves a deeper look
+    int extension = 0;
+    if (!in_root && depth >= 8 && move == singular_candidate.move) {
+      const int singular_beta = singular_candidate.score - depth * 2;
+      const int singular_depth = (depth - 1) / 2;
+
+      stats_.increment(SearchStats::kSingularSearches);
+
+      search_stack->excluded_move = move;
+      const int singular_score = search<NodeType::kNonPV>(singular_depth, ply, singular_beta - 1, singular_beta);
+      search_stack->excluded_move = Move::null_move();
+
+      if (singular_score < singular_beta) {
+        stats_.increment(SearchStats::kSingularExtensions);
+        extension = 1;
+      } else if (singular_beta >= beta) {
+        // multi-cut: another move also beats beta without the tt move, so this node will most likely fail high anyway
+        stats_.increment(SearchStats::kMultiCuts);
+        return singular_beta;
+      }
+    }
+
+    search_stack->continuation_entry = move_history_.get_continuation_entry(move);
     board_.make_move(move);
 
     time_mgmt_.update_nodes_searched();
@@ -328,10 +536,10 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
 
     // clear the child pv so the pv for this node is accurate
     if (in_pv_node) {
-      search_stack->ahead()->pv.clear();
+      pv_table_.clear(ply + 1);
     }
 
-    const int new_depth = depth - 1;
+    const int new_depth = depth - 1 + extension;
     int score;
 
     // principal variation search (pvs)
@@ -342,7 +550,7 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
     // therefore, we save time on searching moves that are less likely to be good by reducing the search depth for them
     if (depth > 2 && moves_tried >= 1 + in_root * 2) {
       int reduction = kLateMoveReductionTable[depth][moves_tried];
-      if (is_quiet) reduction -= move_history_.get_history_score(move, state.turn) / 2048;
+      if (is_quiet) reduction -= history_score / 2048;
       else reduction /= 2;
       reduction -= in_pv_node;
       reduction -= state.checkers != 0;
@@ -350,71 +558,95 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
       reduction = std::clamp(reduction, 0, new_depth - 1);
 
       // null window search for a quick refutation or indication of a potentially good move
-      score = -search<NodeType::kNonPV>(new_depth - reduction, ply + 1, -alpha - 1, -alpha, result);
+      score = -search<NodeType::kNonPV>(new_depth - reduction, ply + 1, -alpha - 1, -alpha);
       needs_full_search = score > alpha && reduction > 0;
+
+      stats_.increment(SearchStats::kLateMoveReductions);
+      if (needs_full_search) {
+        stats_.increment(SearchStats::kLateMoveReSearches);
+      }
     } else {
       needs_full_search = !in_pv_node || moves_tried >= 1;
     }
 
     if (needs_full_search) {
-      score = -search<NodeType::kNonPV>(new_depth, ply + 1, -alpha - 1, -alpha, result);
+      score = -search<NodeType::kNonPV>(new_depth, ply + 1, -alpha - 1, -alpha);
     }
 
     // if the move looks promising from null window search, re-search to obtain a more accurate score
     if (in_pv_node && (score > alpha || moves_tried == 0)) {
-      score = -search<NodeType::kPV>(new_depth, ply + 1, -beta, -alpha, result);
+      score = -search<NodeType::kPV>(new_depth, ply + 1, -beta, -alpha);
     }
 
     board_.undo_move();
     moves_tried++;
 
     if (in_root)
-      time_mgmt_.update_node_spent_table(move, prev_nodes_searched);
+      root_moves_[root_move_idx - 1].nodes += time_mgmt_.get_nodes_searched() - prev_nodes_searched;
     if (time_mgmt_.times_up())
       break;
 
+    // a root move that doesn't raise alpha only has an upper bound on its score, unless it's the first one searched
+    if (in_root) {
+      auto &root_move = root_moves_[root_move_idx - 1];
+      if (moves_tried == 1 || score > alpha) {
+        root_move.score = score;
+        root_move.sel_depth = sel_depth_;
+        root_move.pv_line.clear();
+        root_move.pv_line.push(move);
+        pv_table_.append_to(ply + 1, root_move.pv_line);
+      } else {
+        root_move.score = -eval::kInfiniteScore;
+      }
+    }
+
     // alpha is raised, therefore this move is the new pv node for this depth
     best_score = std::max(best_score, score);
     if (best_score > alpha) {
       best_move = move;
       alpha = best_score;
 
-      if (in_root) {
-        result.best_move = best_move;
-        result.score = best_score;
+      // the root moves aren't sorted until the search returns, so the line's first move is still the previous best
+      if (in_root && move != root_moves_[pv_index_].move) {
+        tracer::record(tracer::EventType::kRootMoveChange, best_move.get_data(), best_score);
       }
 
+      // the new best move followed by the child's pv becomes this ply's pv
       if (in_pv_node) {
-        // clear this ply's pv if a new best move was discovered
-        search_stack->pv.clear();
-        // add the new best move to the pv
-        search_stack->pv.push(move);
-
-        // copy over the child's pv to this ply's pv
-        auto &child_pv = search_stack->ahead()->pv;
-        for (int child_pv_move = 0; child_pv_move < child_pv.length(); child_pv_move++) {
-          search_stack->pv.push(child_pv[child_pv_move]);
-        }
+        pv_table_.update(ply, move);
       }
 
       // this opponent has a better move, so we prune this branch
       if (alpha >= beta) {
+        stats_.increment(SearchStats::kBetaCutoffs);
+        if (moves_tried == 1) {
+          stats_.increment(SearchStats::kFirstMoveBetaCutoffs);
+        }
+
         if (is_quiet) {
           move_history_.update_killer_move(move, ply);
           move_history_.update_counter_move(state.move_played, move);
-          move_history_.update_move_history(move, quiet_non_cutoffs, state.turn, depth);
+          move_history_.update_move_history(move, quiet_non_cutoffs, state.turn, depth, continuations);
         }
+        move_history_.update_capture_history(move, capture_non_cutoffs, depth);
         break;
       }
     }
 
-    if (is_quiet && move != best_move) {
-      quiet_non_cutoffs.push(move);
+    if (move != best_move) {
+      if (is_quiet) {
+        quiet_non_cutoffs.push(move);
+      } else if (is_capture) {
+        capture_non_cutoffs.push(move);
+      }
     }
   }
 
-  // the game is over if we couldn't try a move
+  // the game is over if we couldn't try a move, unless the only move was the excluded one
   if (moves_tried == 0) {
+    if (in_singular_search) {
+      return alpha;
+    }
     return in_check ? -eval::kMateScore + ply : eval::kDrawScore;
   }
 
@@ -432,102 +664,254 @@ int Search::search(int depth, int ply, int alpha, int beta, Result &result) {
     entry.flag = TranspositionTable::Entry::kExact;
   }
 
-  transpo.save(state.zobrist_key, entry, ply);
+  // learn the evaluation's error from quiet positions, where the search result is comparable to the static evaluation
+  // a bound only tells which side of the evaluation the real score lies on if it points away from the evaluation
+  const bool is_quiet_node = !in_check && (best_move.is_null() || !best_move.is_tactical(state));
+  if (is_quiet_node && !in_singular_search && !time_mgmt_.times_up() && !eval::is_mate_score(best_score) &&
+      !(entry.flag == TranspositionTable::Entry::kLowerBound && best_score <= raw_eval) &&
+      !(entry.flag == TranspositionTable::Entry::kUpperBound && best_score >= raw_eval)) {
+    correction_history_.update(state, depth, best_score, raw_eval);
+  }
+
+  // the result of a search without the best move isn't the position's score, so it must not reach the tt
+  // the same goes for the root's later multipv lines, which leave out the moves of the lines before them
+  if (!in_singular_search && !(in_root && pv_index_ > 0)) {
+    transpo.save(state.zobrist_key, entry, ply);
+  }
   return best_score;
 }
 
 Search::Result Search::iterative_deepening() {
   Search::Result result;
 
-  move_history_.decay_move_history();
+  // the history of the previous move's search still mostly applies, since the positions are closely related
+  // the evaluation's errors belong to the pawn structures rather than the search, so its corrections are kept whole
+  move_history_.age();
+
+  if (root_moves_.empty()) {
+    return result;
+  }
 
-  const int config_depth = time_mgmt_.get_config().depth;
-  const int max_search_depth = config_depth ? config_depth : kMaxSearchDepth;
+  // a move is played even if the search is stopped before the first iteration finishes
+  result.best_move = root_moves_.front().move;
+
+  const auto &config = time_mgmt_.get_config();
+  const int max_search_depth = config.depth ? config.depth : kMaxSearchDepth;
+  const int multi_pv = std::clamp<int>(config.multi_pv, 1, root_moves_.size());
 
   for (int depth = 1; depth <= max_search_depth; depth++) {
-    sel_depth_ = 0;
+    const auto iteration_start_nodes = time_mgmt_.get_nodes_searched();
+    tracer::record(tracer::EventType::kIterationStart, depth);
 
-    int alpha = -eval::kInfiniteScore;
-    int beta = eval::kInfiniteScore;
+    // nothing from here until the info output is allowed to allocate
+    allocation_tracker::set_phase(allocation_tracker::Phase::kSearch);
 
-    const int kAspirationMinDepth = 4;
-    const int kAspirationStartWindow = 15;
+    for (auto &root_move : root_moves_) {
+      root_move.previous_score = root_move.score;
+      root_move.score = -eval::kInfiniteScore;
+    }
 
-    int window = kAspirationStartWindow;
-    int fail_high_count = 0;
+    // each multipv line is the best of the root moves left after the lines before it
+    for (pv_index_ = 0; pv_index_ < multi_pv; pv_index_++) {
+      sel_depth_ = 0;
+
+      int alpha = -eval::kInfiniteScore;
+      int beta = eval::kInfiniteScore;
+
+      const int kAspirationMinDepth = 4;
+      const int kAspirationStartWindow = 15;
+
+      // the window is centered on the line's score from the previous iteration, and only widened from then on
+      const int previous_score = root_moves_[pv_index_].previous_score;
+      int window = kAspirationStartWindow;
+      int fail_high_count = 0;
 
-    while (true) {
       if (depth >= kAspirationMinDepth) {
-        alpha = std::max(-eval::kInfiniteScore, result.score - window);
-        beta = std::min(eval::kInfiniteScore, result.score + window);
+        alpha = std::max(-eval::kInfiniteScore, previous_score - window);
+        beta = std::min(eval::kInfiniteScore, previous_score + window);
       }
 
-      Result new_result;
-      search<NodeType::kRoot>(depth - std::min(2, fail_high_count), 0, alpha, beta, new_result);
+      while (true) {
+        const int score = search<NodeType::kRoot>(depth - std::min(2, fail_high_count), 0, alpha, beta);
 
-      if (!new_result.best_move.is_null()) {
-        result = new_result;
-        result.pv_line = stack_.front().pv;
-      } else {
-        break;
+        // moves that failed low keep the order they were searched in, behind the moves with a score
+        sort_root_moves(pv_index_, root_moves_.size());
+
+        if (time_mgmt_.times_up()) {
+          tracer::record(tracer::EventType::kHardStop, static_cast<int>(time_mgmt_.time_elapsed()));
+          break;
+        }
+
+        if (score <= alpha) {
+          tracer::record(tracer::EventType::kAspirationFailLow, alpha, beta);
+
+          // adjust beta to be midpoint between alpha and itself
+          // this adjustment narrows the [alpha, beta] window based, effectively lowering the expectation for what constitutes an acceptable move
+          beta = (alpha + beta) / 2;
+
+          // decrease alpha by the window size to expand the search range downwards
+          // this ensures the search encompasses potentially better moves that were previously outside the initial narrower window
+          alpha = std::max(-eval::kInfiniteScore, alpha - window);
+
+          // reset fail_high_count to zero since the window adjustment
+          // requires a fresh evaluation of high-fail occurrences without previous bias
+          fail_high_count = 0;
+        }
+        else if (score >= beta) {
+          tracer::record(tracer::EventType::kAspirationFailHigh, alpha, beta);
+          // increase beta by the window size to extend the upper search range
+          // this adjustment allows the search to explore further along this promising path without cutting off due to an overly restrictive beta bound
+          beta = std::min(eval::kInfiniteScore, beta + window);
+
+          // search to lower depths as fail highs (beta cutoffs) increase
+          if (score < 2000) {
+            fail_high_count++;
+          }
+        }
+        else
+          break;
+
+        window += window / 2;
       }
 
+      // the lines found so far are ordered among themselves
+      sort_root_moves(0, pv_index_ + 1);
+
       if (time_mgmt_.times_up()) {
         break;
       }
+    }
 
-      if (new_result.score <= alpha) {
-        // adjust beta to be midpoint between alpha and itself
-        // this adjustment narrows the [alpha, beta] window based, effectively lowering the expectation for what constitutes an acceptable move
-        beta = (alpha + beta) / 2;
+    const auto &best_root_move = root_moves_.front();
+    result.best_move = best_root_move.move;
+    result.score = reported_score(best_root_move);
+    result.pv_line = best_root_move.pv_line;
 
-        // decrease alpha by the window size to expand the search range downwards
-        // this ensures the search encompasses potentially better moves that were previously outside the initial narrower window
-        alpha = std::max(-eval::kInfiniteScore, alpha - window);
+    allocation_tracker::set_phase(allocation_tracker::Phase::kOutput);
 
-        // reset fail_high_count to zero since the window adjustment
-        // requires a fresh evaluation of high-fail occurrences without previous bias
-        fail_high_count = 0;
-      }
-      else if (new_result.score >= beta) {
-        // increase beta by the window size to extend the upper search range
-        // this adjustment allows the search to explore further along this promising path without cutting off due to an overly restrictive beta bound
-        beta = std::min(eval::kInfiniteScore, beta + window);
-
-        // search to lower depths as fail highs (beta cutoffs) increase
-        if (new_result.score < 2000) {
-          fail_high_count++;
-        }
+    for (int line = 0; line < multi_pv; line++) {
+      auto &root_move = root_moves_[line];
+
+      // a line the stopped iteration didn't get to is reported as the previous iteration left it
+      const bool searched = root_move.score != -eval::kInfiniteScore;
+      const int line_score = reported_score(root_move);
+      if (!searched && (depth == 1 || line_score == -eval::kInfiniteScore)) {
+        continue;
       }
-      else
-        break;
 
-      window += window / 2;
+      const bool is_mate = eval::is_mate_score(line_score);
+      std::cout << std::format("info depth {} seldepth {}{} score {} {} nodes {} nps {} time {} hashfull {} pv {}",
+                               searched ? depth : depth - 1,
+                               root_move.sel_depth,
+                               multi_pv > 1 ? std::format(" multipv {}", line + 1) : "",
+                               is_mate ? "mate" : "cp",
+                               is_mate ? eval::mate_in(line_score) : line_score,
+                               time_mgmt_.get_nodes_searched(),
+                               time_mgmt_.nodes_per_second(),
+                               time_mgmt_.time_elapsed(),
+                               board_.get_transpo_table().hash_full(),
+                               root_move.pv_line.to_string()) << std::endl;
     }
 
-    const bool is_mate = eval::is_mate_score(result.score);
-    std::cout << std::format("info depth {} seldepth {} score {} {} nodes {} nps {} time {} hashfull {} pv {}",
-                             depth,
-                             sel_depth_,
-                             is_mate ? "mate" : "cp",
-                             is_mate ? eval::mate_in(result.score) : result.score,
-                             time_mgmt_.get_nodes_searched(),
-                             time_mgmt_.nodes_per_second(),
-                             time_mgmt_.time_elapsed(),
-                             board_.get_transpo_table().hash_full(),
-                             result.pv_line.to_string()) << std::endl;
+    stats_.record_iteration(depth, time_mgmt_.get_nodes_searched() - iteration_start_nodes);
+    stats_.print();
 
-    if (time_mgmt_.soft_times_up(result.best_move)) {
+    tracer::record(tracer::EventType::kIterationEnd, depth, result.score);
+
+    if (time_mgmt_.times_up()) {
+      break;
+    }
+
+    // the more of the effort the best move takes, the more settled the search is on it
+    const double best_move_node_fraction = static_cast<double>(best_root_move.nodes) /
+                                           static_cast<double>(std::max(1LL, time_mgmt_.get_nodes_searched()));
+    const bool soft_times_up = time_mgmt_.soft_times_up(best_move_node_fraction);
+    tracer::record(tracer::EventType::kSoftTimeCheck, static_cast<int>(time_mgmt_.time_elapsed()), soft_times_up);
+
+    if (soft_times_up) {
       break;
     }
   }
 
+  allocation_tracker::set_phase(allocation_tracker::Phase::kOther);
   return result;
 }
 
+void Search::generate_root_moves() {
+  root_moves_.clear();
+
+  auto &root_stack = stack_.front();
+  root_stack.ply = 0;
+  root_stack.attacks.reset();
+
+  const auto &state = board_.get_state();
+  const auto &tt_entry = board_.get_transpo_table().probe(state.zobrist_key);
+  const Move tt_move = tt_entry.compare_key(state.zobrist_key) ? tt_entry.move : Move::null_move();
+
+  const auto &search_moves = time_mgmt_.get_config().search_moves;
+
+  MovePicker move_picker(MovePickerType::kSearch, board_, tt_move, move_history_, &root_stack);
+  Move move = Move::null_move();
+  while (move = move_picker.next()) {
+    if (!board_.is_move_legal(move, root_stack.attacks)) {
+      continue;
+    }
+
+    if (!search_moves.empty() && std::find(search_moves.begin(), search_moves.end(), move) == search_moves.end()) {
+      continue;
+    }
+
+    // the picker can return the tt move a second time
+    const bool duplicate = std::any_of(root_moves_.begin(), root_moves_.end(), [&move](const RootMove &root_move) {
+      return root_move.move == move;
+    });
+    if (!duplicate) {
+      root_moves_.emplace_back(move);
+    }
+  }
+}
+
+void Search::sort_root_moves(int first, int last) {
+  // an insertion sort, since std::stable_sort may allocate in the middle of the search
+  const auto begin = root_moves_.begin();
+  for (int i = first + 1; i < last; i++) {
+    const auto insert_at = std::upper_bound(begin + first, begin + i, root_moves_[i]);
+    std::rotate(insert_at, begin + i, begin + i + 1);
+  }
+}
+
+int Search::reported_score(const RootMove &root_move) const {
+  return root_move.score != -eval::kInfiniteScore ? root_move.score : root_move.previous_score;
+}
+
 Search::Result Search::go() {
+  stats_ = SearchStats();
+  generate_root_moves();
+
   time_mgmt_.start();
   const auto result = iterative_deepening();
   time_mgmt_.stop();
   return result;
+}
+
+void Search::new_game() {
+  move_history_.clear();
+  correction_history_.clear();
+}
+
+int Search::quiescence(PVLine &pv) {
+  pv_table_.clear(0);
+
+  const int score = quiesce<NodeType::kPV>(0, -eval::kInfiniteScore, eval::kInfiniteScore);
+  pv = pv_table_.get(0);
+
+  return score;
+}
+
+long long Search::get_nodes_searched() const {
+  return time_mgmt_.get_nodes_searched();
+}
+
+const SearchStats &Search::get_stats() const {
+  return stats_;
 }
\ No newline at end of file
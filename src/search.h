@@ -5,6 +5,10 @@
 #include "eval.h"
 #include "time_mgmt.h"
 #include "history.h"
+#include "search_stats.h"
+
+#include <algorithm>
+#include <vector>
 
 const int kMaxSearchDepth = 100;
 const int kScoreNone = -eval::kInfiniteScore;
@@ -49,6 +53,49 @@ struct PVLine {
   List<Move, kMaxPlyFromRoot> moves_;
 };
 
+// the principal variations of every ply of the search, in a triangular array: the pv found at a ply is never longer than
+// the plies left below it, so each ply's row has room for one move less than the row before it
+class PVTable {
+ public:
+  PVTable() : lengths_({}) {}
+
+  void clear(int ply) {
+    lengths_[ply] = 0;
+  }
+
+  // makes the move followed by the next ply's pv the pv of this ply
+  void update(int ply, const Move &move) {
+    Move *row = &moves_[row_offset(ply)];
+    const Move *child_row = &moves_[row_offset(ply + 1)];
+    const int child_length = lengths_[ply + 1];
+
+    row[0] = move;
+    std::copy(child_row, child_row + child_length, row + 1);
+    lengths_[ply] = child_length + 1;
+  }
+
+  void append_to(int ply, PVLine &pv_line) const {
+    for (int i = 0; i < lengths_[ply]; i++) {
+      pv_line.push(moves_[row_offset(ply) + i]);
+    }
+  }
+
+  [[nodiscard]] PVLine get(int ply) const {
+    PVLine pv_line;
+    append_to(ply, pv_line);
+    return pv_line;
+  }
+
+ private:
+  static constexpr int row_offset(int ply) {
+    return ply * (2 * kMaxPlyFromRoot - ply + 1) / 2;
+  }
+
+  std::array<Move, kMaxPlyFromRoot * (kMaxPlyFromRoot + 1) / 2> moves_;
+  // one more than there are rows, so the pv of the ply past the last row is always empty
+  std::array<int, kMaxPlyFromRoot + 1> lengths_;
+};
+
 enum class NodeType {
   kRoot,
   kPV,
@@ -66,11 +113,21 @@ class Search {
   };
 
   struct Stack {
-    [[maybe_unused]] int ply;
+    int ply;
     int static_eval;
-    PVLine pv;
-
-    Stack() : static_eval(kScoreNone), ply(0) {}
+    // attacks in the position at this ply, filled lazily by legality checks, SEE and move ordering
+    AttackInfo attacks;
+    // move left out of the search at this ply while verifying that the tt move is singular
+    Move excluded_move;
+    // continuation history of the move played from this ply, null after a null move
+    MoveHistory::ContinuationEntry *continuation_entry;
+
+    Stack() : static_eval(kScoreNone), ply(0), excluded_move(Move::null_move()), continuation_entry(nullptr) {}
+
+    // the continuation histories of the moves one and two plies before this one
+    MoveHistory::Continuations continuations() {
+      return {ply >= 1 ? behind(1)->continuation_entry : nullptr, ply >= 2 ? behind(2)->continuation_entry : nullptr};
+    }
 
     Stack *ahead(int amount = 1) {
       return this + amount;
@@ -81,28 +138,79 @@ class Search {
     }
   };
 
+  // a legal move of the root position, with what the iterations so far found out about it
+  struct RootMove {
+    Move move;
+    // the score of the current iteration, -infinity until the move is searched and if it only failed low
+    int score;
+    // the score the move had at the end of the previous iteration
+    int previous_score;
+    // nodes spent on the move across every iteration
+    long long nodes;
+    int sel_depth;
+    PVLine pv_line;
+
+    explicit RootMove(const Move &move)
+        : move(move), score(-eval::kInfiniteScore), previous_score(-eval::kInfiniteScore), nodes(0), sel_depth(0) {}
+
+    // the better move is ordered first, the previous iteration decides between moves that fell below alpha
+    bool operator<(const RootMove &other) const {
+      return score != other.score ? score > other.score : previous_score > other.previous_score;
+    }
+  };
+
   explicit Search(TimeManagement::Config &time_config, Board &board);
 
   static std::array<std::array<int, kMaxPlyFromRoot>, kMaxSearchDepth + 1> kLateMoveReductionTable;
 
   static void init_tables();
 
+  // searches the board's position, starting from the aged history of the searches before it
   Result go();
 
+  // forgets what earlier searches learned, for when they were searching another game
+  void new_game();
+
+  // scores the board with a full window quiescence search alone, the pv holds the capture sequence it settled on
+  // the board's transposition table is used as is, and no time limit applies
+  int quiescence(PVLine &pv);
+
+  [[nodiscard]] long long get_nodes_searched() const;
+
+  [[nodiscard]] const SearchStats &get_stats() const;
+
  private:
+  // depth counts down from 0 at the first ply of quiescence search, which is the only ply that searches quiet checks
   template<NodeType node_type>
-  int quiesce(int ply, int alpha, int beta);
+  int quiesce(int ply, int alpha, int beta, int depth = 0);
 
   template<NodeType node_type>
-  int search(int depth, int ply, int alpha, int beta, Result &result);
+  int search(int depth, int ply, int alpha, int beta);
 
   Result iterative_deepening();
 
+  // fills the root move list with the legal moves of the position (only the searchmoves, if any were given), in the
+  // order the move picker would search them
+  void generate_root_moves();
+
+  // orders the root moves in [first, last) best first, keeping the relative order of equal moves
+  void sort_root_moves(int first, int last);
+
+  // the score of the root move to report, which is the previous iteration's if the move wasn't searched in this one
+  [[nodiscard]] int reported_score(const RootMove &root_move) const;
+
  private:
   Board &board_;
   TimeManagement time_mgmt_;
   MoveHistory move_history_;
+  CorrectionHistory correction_history_;
   std::array<Stack, kMaxPlyFromRoot> stack_;
+  PVTable pv_table_;
+  // the moves searched at the root, sorted best first after each search of them
+  std::vector<RootMove> root_moves_;
+  // the root moves before this index are the multipv lines already searched in this iteration
+  int pv_index_;
+  SearchStats stats_;
   int sel_depth_;
 };
 
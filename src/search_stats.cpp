@@ -0,0 +1,87 @@
+#include "search_stats.h"
+
+#include <format>
+
+SearchStats &SearchStats::operator+=(const SearchStats &other) {
+  for (int i = 0; i < kNumCounters; i++) {
+    counters_[i] += other.counters_[i];
+  }
+  for (int depth = 0; depth <= other.max_depth_; depth++) {
+    iteration_nodes_[depth] += other.iteration_nodes_[depth];
+  }
+  max_depth_ = std::max(max_depth_, other.max_depth_);
+  return *this;
+}
+
+void SearchStats::clear() {
+  counters_.fill(0ULL);
+  iteration_nodes_.fill(0ULL);
+  max_depth_ = 0;
+}
+
+void SearchStats::print() const {
+  if constexpr (!kEnabled) {
+    return;
+  }
+
+  const auto percent = [this](Counter part, Counter whole) {
+    return 100.0 * static_cast<double>(counters_[part]) / static_cast<double>(std::max<U64>(counters_[whole], 1));
+  };
+
+  const U64 total_nodes = counters_[kSearchNodes] + counters_[kQuiescenceNodes];
+  std::cout << std::format("info string stats nodes search {} qsearch {} ({:.1f}% qsearch)",
+                           counters_[kSearchNodes],
+                           counters_[kQuiescenceNodes],
+                           100.0 * counters_[kQuiescenceNodes] / std::max<U64>(total_nodes, 1)) << std::endl;
+
+  std::cout << std::format("info string stats tt pv {:.1f}% hit, nonpv {:.1f}% hit {:.1f}% cut, qsearch {:.1f}% hit {:.1f}% cut",
+                           percent(kTTHitsPV, kTTProbesPV),
+                           percent(kTTHitsNonPV, kTTProbesNonPV),
+                           percent(kTTCutoffsNonPV, kTTProbesNonPV),
+                           percent(kTTHitsQuiescence, kTTProbesQuiescence),
+                           percent(kTTCutoffsQuiescence, kTTProbesQuiescence)) << std::endl;
+
+  std::cout << std::format("info string stats beta cutoffs {} first move {:.1f}%, upcoming repetitions {}",
+                           counters_[kBetaCutoffs],
+                           percent(kFirstMoveBetaCutoffs, kBetaCutoffs),
+                           counters_[kUpcomingRepetitions]) << std::endl;
+
+  std::cout << std::format("info string stats pruning rfp {} razoring {} nmp {}/{} probcut {}/{} lmp {} fp {} history {} see {} "
+                           "lmr {} re-searches {} ({:.1f}%)",
+                           counters_[kReverseFutilityPrunes],
+                           counters_[kRazoringPrunes],
+                           counters_[kNullMovePrunes],
+                           counters_[kNullMoveSearches],
+                           counters_[kProbCutPrunes],
+                           counters_[kProbCutSearches],
+                           counters_[kLateMovePrunes],
+                           counters_[kFutilityPrunes],
+                           counters_[kHistoryPrunes],
+                           counters_[kSEEPrunes],
+                           counters_[kLateMoveReductions],
+                           counters_[kLateMoveReSearches],
+                           percent(kLateMoveReSearches, kLateMoveReductions)) << std::endl;
+
+  std::cout << std::format("info string stats singular searches {} extensions {} ({:.1f}%) multi-cuts {} ({:.1f}%)",
+                           counters_[kSingularSearches],
+                           counters_[kSingularExtensions],
+                           percent(kSingularExtensions, kSingularSearches),
+                           counters_[kMultiCuts],
+                           percent(kMultiCuts, kSingularSearches)) << std::endl;
+
+  // the branching factor of a depth is how many more nodes it took than the depth before it
+  std::string branching_factors;
+  for (int depth = 2; depth <= max_depth_; depth++) {
+    if (iteration_nodes_[depth - 1] == 0) {
+      continue;
+    }
+
+    const double branching_factor =
+        static_cast<double>(iteration_nodes_[depth]) / static_cast<double>(iteration_nodes_[depth - 1]);
+    branching_factors += std::format(" {}:{:.2f}", depth, branching_factor);
+  }
+
+  if (!branching_factors.empty()) {
+    std::cout << std::format("info string stats branching factor{}", branching_factors) << std::endl;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef INTEGRAL_SEARCH_STATS_H_
+#define INTEGRAL_SEARCH_STATS_H_
+
+#include "board.h"
+
+#include <array>
+
+// counters for which parts of the search actually fire
+// these are only compiled in when SEARCH_STATS is defined (cmake -DSEARCH_STATS=ON), otherwise every update is a no-op
+class SearchStats {
+ public:
+#ifdef SEARCH_STATS
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  enum Counter : int {
+    kSearchNodes,
+    kQuiescenceNodes,
+    kTTProbesPV,
+    kTTHitsPV,
+    kTTProbesNonPV,
+    kTTHitsNonPV,
+    kTTCutoffsNonPV,
+    kTTProbesQuiescence,
+    kTTHitsQuiescence,
+    kTTCutoffsQuiescence,
+    kUpcomingRepetitions,
+    kBetaCutoffs,
+    kFirstMoveBetaCutoffs,
+    kReverseFutilityPrunes,
+    kRazoringPrunes,
+    kNullMoveSearches,
+    kNullMovePrunes,
+    kProbCutSearches,
+    kProbCutPrunes,
+    kLateMovePrunes,
+    kFutilityPrunes,
+    kHistoryPrunes,
+    kSEEPrunes,
+    kLateMoveReductions,
+    kLateMoveReSearches,
+    kSingularSearches,
+    kSingularExtensions,
+    kMultiCuts,
+    kNumCounters
+  };
+
+  SearchStats() : counters_({}), iteration_nodes_({}), max_depth_(0) {}
+
+  inline void increment(Counter counter) {
+    if constexpr (kEnabled) {
+      counters_[counter]++;
+    }
+  }
+
+  // records how many nodes the iteration at this depth took, used for the branching factor
+  inline void record_iteration(int depth, U64 nodes) {
+    if constexpr (kEnabled) {
+      iteration_nodes_[depth] += nodes;
+      max_depth_ = std::max(max_depth_, depth);
+    }
+  }
+
+  [[nodiscard]] U64 get(Counter counter) const {
+    return counters_[counter];
+  }
+
+  SearchStats &operator+=(const SearchStats &other);
+
+  void clear();
+
+  // prints the counters as uci info strings
+  void print() const;
+
+ private:
+  std::array<U64, kNumCounters> counters_;
+  std::array<U64, kMaxPlyFromRoot> iteration_nodes_;
+  int max_depth_;
+};
+
+#endif // INTEGRAL_SEARCH_STATS_H_
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "time_mgmt.h"
 
+#include <algorithm>
 #include <thread>
 
 TimeManagement::TimeManagement(const TimeManagement::Config &config, Board &board)
@@ -8,8 +9,7 @@ TimeManagement::TimeManagement(const TimeManagement::Config &config, Board &boar
       current_move_time_(0),
       times_up_(false),
       worker_processed_(false),
-      nodes_searched_(0),
-      node_spent_table_({}) {}
+      nodes_searched_(0) {}
 
 const TimeManagement::Config &TimeManagement::get_config() {
   return config_;
@@ -17,7 +17,11 @@ const TimeManagement::Config &TimeManagement::get_config() {
 
 void TimeManagement::start() {
   start_time_ = std::chrono::steady_clock::now();
-  node_spent_table_.fill(0ULL);
+  nodes_searched_ = 0;
+
+  // the same time management can run several searches one after another
+  times_up_ = false;
+  worker_processed_ = false;
 
   // stop after the hard limit has been passed
   worker = std::thread([this] {
@@ -54,34 +58,29 @@ void TimeManagement::stop() {
 
 [[nodiscard]] long long TimeManagement::calculate_hard_limit() {
   const auto &state = board_.get_state();
-  return config_.move_time ? config_.move_time : config_.time[state.turn] / 20 + config_.increment[state.turn] / 2;
+  const long long limit =
+      config_.move_time ? config_.move_time : config_.time[state.turn] / 20 + config_.increment[state.turn] / 2;
+  return std::max(1LL, limit - config_.time_used);
 }
 
-[[nodiscard]] long long TimeManagement::calculate_soft_limit(const Move &pv_move) {
-  if (config_.move_time) return config_.move_time;
+[[nodiscard]] long long TimeManagement::calculate_soft_limit(double best_move_node_fraction) {
+  if (config_.move_time) return calculate_hard_limit();
 
   // taken from chessatron
-  const auto best_move_fraction =
-      static_cast<double>(node_spent_table_[pv_move.get_data() & 0xFFF]) / std::max(1LL, nodes_searched_);
   const auto hard_limit = calculate_hard_limit();
-  return ((hard_limit / 10) * 3) * (1.6 - best_move_fraction) * 1.5;
+  return ((hard_limit / 10) * 3) * (1.6 - best_move_node_fraction) * 1.5;
 }
 
 void TimeManagement::update_nodes_searched() {
   ++nodes_searched_;
 }
 
-void TimeManagement::update_node_spent_table(const Move &move, long long prev_nodes_searched) {
-  const long long nodes_spent = nodes_searched_ - prev_nodes_searched;
-  node_spent_table_[move.get_data() & 0xFFF] += nodes_spent;
-}
-
 bool TimeManagement::times_up() const {
   return config_.depth == 0 && times_up_.load();
 }
 
-bool TimeManagement::soft_times_up(const Move &pv_move) {
-  return config_.depth == 0 && time_elapsed() >= calculate_soft_limit(pv_move);
+bool TimeManagement::soft_times_up(double best_move_node_fraction) {
+  return config_.depth == 0 && time_elapsed() >= calculate_soft_limit(best_move_node_fraction);
 }
 
 long long TimeManagement::nodes_per_second() const {
@@ -5,6 +5,7 @@
 #include "board.h"
 
 #include <array>
+#include <vector>
 #include <chrono>
 #include <thread>
 #include <condition_variable>
@@ -16,6 +17,12 @@ class TimeManagement {
     int move_time{};
     std::array<int, 2> time{};
     std::array<int, 2> increment{};
+    // the number of best root moves to search with a full window and report, each with its own pv
+    int multi_pv = 1;
+    // the root moves to choose from, every legal move if empty
+    std::vector<Move> search_moves{};
+    // time already spent on the move before this search (by the mate search), which is taken off its limits
+    int time_used{};
   };
 
   explicit TimeManagement(const Config &config, Board &board);
@@ -28,9 +35,8 @@ class TimeManagement {
 
   void update_nodes_searched();
 
-  void update_node_spent_table(const Move &move, long long prev_nodes_searched);
-
-  [[nodiscard]] bool soft_times_up(const Move &pv_move);
+  // best_move_node_fraction is the share of the nodes searched that went to the best move
+  [[nodiscard]] bool soft_times_up(double best_move_node_fraction);
 
   [[nodiscard]] bool times_up() const;
 
@@ -44,7 +50,7 @@ class TimeManagement {
 
   [[nodiscard]] long long calculate_hard_limit();
 
-  [[nodiscard]] long long calculate_soft_limit(const Move &pv_move);
+  [[nodiscard]] long long calculate_soft_limit(double best_move_node_fraction);
 
  private:
   const Config &config_;
@@ -54,7 +60,6 @@ class TimeManagement {
   long long nodes_searched_;
   std::atomic<bool> times_up_;
   std::atomic<bool> worker_processed_;
-  std::array<long long, 4096> node_spent_table_;
   std::mutex mutex_;
   std::condition_variable times_up_cv_;
   std::thread worker;
@@ -0,0 +1,118 @@
+#include "tracer.h"
+#include "move.h"
+
+#include <chrono>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tracer {
+
+namespace {
+
+// buffers are owned here rather than by the threads, so they outlive the thread that wrote them
+std::mutex buffers_mutex;
+std::vector<std::unique_ptr<Buffer>> buffers;
+
+const auto kTraceStart = std::chrono::steady_clock::now();
+
+std::string_view event_name(EventType type) {
+  switch (type) {
+    case EventType::kIterationStart:
+    case EventType::kIterationEnd:
+      return "iteration";
+    case EventType::kAspirationFailLow:
+      return "aspiration fail low";
+    case EventType::kAspirationFailHigh:
+      return "aspiration fail high";
+    case EventType::kRootMoveChange:
+      return "root move change";
+    case EventType::kSoftTimeCheck:
+      return "soft time check";
+    case EventType::kHardStop:
+      return "hard stop";
+  }
+  return "unknown";
+}
+
+std::string event_args(const Event &event) {
+  switch (event.type) {
+    case EventType::kIterationStart:
+      return std::format(R"({{"depth":{}}})", event.first_arg);
+    case EventType::kIterationEnd:
+      return std::format(R"({{"depth":{},"score":{}}})", event.first_arg, event.second_arg);
+    case EventType::kAspirationFailLow:
+    case EventType::kAspirationFailHigh:
+      return std::format(R"({{"alpha":{},"beta":{}}})", event.first_arg, event.second_arg);
+    case EventType::kRootMoveChange: {
+      const auto data = static_cast<U16>(event.first_arg);
+      const Move move(data & kFromMask, (data & kToMask) >> 6, PromotionType((data & kPromotionTypeMask) >> 12));
+      return std::format(R"({{"move":"{}","score":{}}})", move.to_string(), event.second_arg);
+    }
+    case EventType::kSoftTimeCheck:
+      return std::format(R"({{"elapsed_ms":{},"stop":{}}})", event.first_arg, event.second_arg);
+    case EventType::kHardStop:
+      return std::format(R"({{"elapsed_ms":{}}})", event.first_arg);
+  }
+  return "{}";
+}
+
+}  // namespace
+
+Buffer &thread_buffer() {
+  thread_local Buffer *buffer = nullptr;
+  if (!buffer) [[unlikely]] {
+    std::lock_guard lock(buffers_mutex);
+    buffers.push_back(std::make_unique<Buffer>());
+    buffer = buffers.back().get();
+    buffer->thread_index = static_cast<int>(buffers.size());
+  }
+  return *buffer;
+}
+
+U64 now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kTraceStart).count();
+}
+
+void clear() {
+  std::lock_guard lock(buffers_mutex);
+  for (auto &buffer : buffers) {
+    buffer->count = 0;
+  }
+}
+
+void dump(std::ostream &stream) {
+  std::lock_guard lock(buffers_mutex);
+
+  stream << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+  bool first_event = true;
+  for (const auto &buffer : buffers) {
+    // when the ring buffer has wrapped around, the oldest surviving event sits right after the newest
+    const U64 num_events = std::min<U64>(buffer->count, kBufferCapacity);
+    const U64 first_index = buffer->count - num_events;
+
+    for (U64 i = first_index; i < buffer->count; i++) {
+      const auto &event = buffer->events[i & (kBufferCapacity - 1)];
+
+      // iterations are shown as durations, everything else as instant events
+      const char *phase = event.type == EventType::kIterationStart ? "B"
+                          : event.type == EventType::kIterationEnd ? "E"
+                                                                   : "i";
+
+      stream << std::format(R"({}{{"name":"{}","ph":"{}","ts":{:.3f},"pid":1,"tid":{},"s":"t","args":{}}})",
+                            first_event ? "" : ",",
+                            event_name(event.type),
+                            phase,
+                            static_cast<double>(event.time_ns) / 1000.0,
+                            buffer->thread_index,
+                            event_args(event));
+      first_event = false;
+    }
+  }
+
+  stream << "]}" << std::endl;
+}
+
+}
\ No newline at end of file
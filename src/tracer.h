@@ -0,0 +1,65 @@
+#ifndef INTEGRAL_TRACER_H_
+#define INTEGRAL_TRACER_H_
+
+#include "types.h"
+
+#include <array>
+#include <ostream>
+
+// records fixed-size search events into a per-thread ring buffer, which can later be dumped as chrome trace-event json
+// (viewable in chrome://tracing or perfetto). only compiled in when SEARCH_TRACE is defined (cmake -DSEARCH_TRACE=ON)
+namespace tracer {
+
+#ifdef SEARCH_TRACE
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+enum class EventType : U8 {
+  kIterationStart,
+  kIterationEnd,
+  kAspirationFailLow,
+  kAspirationFailHigh,
+  kRootMoveChange,
+  kSoftTimeCheck,
+  kHardStop,
+};
+
+struct Event {
+  U64 time_ns;
+  EventType type;
+  int first_arg;
+  int second_arg;
+};
+
+// oldest events get overwritten once a thread records more than this
+const int kBufferCapacity = 1 << 16;
+
+struct Buffer {
+  std::array<Event, kBufferCapacity> events;
+  U64 count = 0;
+  int thread_index = 0;
+};
+
+// returns the calling thread's buffer, registering it on first use
+Buffer &thread_buffer();
+
+U64 now_ns();
+
+inline void record(EventType type, int first_arg = 0, int second_arg = 0) {
+  if constexpr (kEnabled) {
+    auto &buffer = thread_buffer();
+    buffer.events[buffer.count++ & (kBufferCapacity - 1)] = {now_ns(), type, first_arg, second_arg};
+  }
+}
+
+// discards every recorded event on all threads
+void clear();
+
+// writes the recorded events of all threads as chrome trace-event json
+void dump(std::ostream &stream);
+
+}
+
+#endif // INTEGRAL_TRACER_H_
\ No newline at end of file
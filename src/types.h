@@ -12,6 +12,9 @@ using U32 = std::uint32_t;
 using U64 = std::uint64_t;
 using U128 = unsigned __int128;
 
+using I16 = std::int16_t;
+using I32 = std::int32_t;
+
 const U8 kNumFiles = 8;
 const U8 kNumRanks = 8;
 const U8 kBoardLength = 8;
@@ -1,13 +1,54 @@
 #include "uci.h"
+#include "allocation_tracker.h"
+#include "bitbase.h"
+#include "cuckoo.h"
 #include "move_gen.h"
 #include "move_picker.h"
+#include "nnue.h"
+#include "perf_counters.h"
+#include "tracer.h"
 
+#include <atomic>
 #include <string>
 #include <format>
 #include <fstream>
+#include <thread>
 
 namespace uci {
 
+const int kTranspositionTableMbSize = 32;
+
+// positions searched by the bench command, the total node count acts as a signature of the search's behavior
+const std::array<std::string, 16> kBenchFens = {{
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+    "r1bqk2r/pp2bppp/2p5/3pP3/P2Q1P2/2N1B3/1PP3PP/R4RK1 b kq - 0 13",
+    "2r3k1/pp3ppp/4p3/3pP3/3P1P2/P1r1B3/1P4PP/R4RK1 w - - 0 21",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+    "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+    "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+    "8/8/1p1r1k2/p1pPN1p1/P3KnP1/1P6/8/3R4 b - - 0 1",
+}};
+
+const int kBenchDepth = 14;
+
+// go mate may use this many milliseconds when it isn't given a time limit
+const int kMateDefaultTime = 10000;
+// the mate search may use up to this share of a move's time, the regular search gets what it leaves
+const int kMateSearchTimeDivisor = 2;
+
+// the number of best lines the search reports, set with the MultiPV option
+const int kMaxMultiPV = 256;
+int multi_pv_lines = 1;
+
 void position(Board &board, std::stringstream &input_stream) {
   std::string position_type;
   input_stream >> position_type;
@@ -19,7 +60,6 @@ void position(Board &board, std::stringstream &input_stream) {
     position_fen = fen::kStartFen;
   }
 
-  const int kTranspositionTableMbSize = 32;
   if (!board.initialized()) {
     board = Board(kTranspositionTableMbSize);
   }
@@ -41,12 +81,33 @@ void position(Board &board, std::stringstream &input_stream) {
   }
 }
 
-void go(Board &board, std::stringstream &input_stream) {
-  TimeManagement::Config time_config{};
+void go(Board &board,
+        Search &search,
+        MateSearch &mate_search,
+        TimeManagement::Config &time_config,
+        std::stringstream &input_stream) {
+  time_config = {};
+  time_config.multi_pv = multi_pv_lines;
+  bool profile = false;
+  int mate_moves = 0;
+
+  // searchmoves takes every move that follows it, up to the next option
+  bool reading_search_moves = false;
 
   std::string option;
   while (input_stream >> option) {
-    if (option == "wtime") {
+    if (reading_search_moves) {
+      const auto move = Move::from_str(board.get_state(), option);
+      if (move.has_value()) {
+        time_config.search_moves.push_back(move.value());
+        continue;
+      }
+      reading_search_moves = false;
+    }
+
+    if (option == "searchmoves") {
+      reading_search_moves = true;
+    } else if (option == "wtime") {
       input_stream >> time_config.time[Color::kWhite];
     } else if (option == "btime") {
       input_stream >> time_config.time[Color::kBlack];
@@ -58,18 +119,64 @@ void go(Board &board, std::stringstream &input_stream) {
       input_stream >> time_config.move_time;
     } else if (option == "depth") {
       input_stream >> time_config.depth;
+    } else if (option == "mate") {
+      input_stream >> mate_moves;
     } else if (option == "infinite") {
       time_config.depth = kMaxSearchDepth;
     } else if (option == "perft") {
       perft(board, input_stream);
       return;
+    } else if (option == "profile") {
+      profile = true;
     }
   }
 
-  if (option.empty())
+  const bool has_limits = time_config.depth || time_config.move_time || time_config.time[Color::kWhite] ||
+                          time_config.time[Color::kBlack];
+  if (!has_limits)
     time_config.depth = kMaxSearchDepth;
 
-  const auto search_result = Search(time_config, board).go();
+  // mates are looked for with the proof-number search first. nothing could stop a search without a time limit, so
+  // without any limits the mate search and the regular search after it share a fixed amount of time
+  if (mate_moves > 0) {
+    if (!has_limits) {
+      time_config.depth = 0;
+      time_config.move_time = kMateDefaultTime;
+    }
+
+    // the mate search may use part of the move's time (of the fixed amount with only a depth limit), and the regular
+    // search gets what it leaves
+    const bool has_time_limit = time_config.move_time || time_config.time[board.get_state().turn];
+    const long long move_time_limit =
+        has_time_limit ? TimeManagement(time_config, board).calculate_hard_limit() : kMateDefaultTime;
+
+    TimeManagement::Config mate_config{};
+    mate_config.move_time = static_cast<int>(std::max(1LL, move_time_limit / kMateSearchTimeDivisor));
+
+    const auto mate_result = mate_search.go(mate_moves, mate_config);
+    if (!mate_result.best_move.is_null()) {
+      std::cout << std::format("bestmove {}", mate_result.best_move.to_string()) << std::endl;
+      return;
+    }
+
+    std::cout << std::format("info string no mate in {} found", mate_moves) << std::endl;
+    time_config.time_used = static_cast<int>(mate_search.time_elapsed());
+  }
+
+  // only open the hardware counters when asked to, since it costs a few syscalls
+  std::optional<PerfCounters> perf_counters;
+  if (profile) {
+    perf_counters.emplace();
+    perf_counters->start();
+  }
+
+  const auto search_result = search.go();
+
+  if (perf_counters.has_value()) {
+    perf_counters->stop();
+    perf_counters->print(search.get_nodes_searched());
+  }
+
   std::cout << std::format("bestmove {}", search_result.best_move.to_string()) << std::endl;
 }
 
@@ -115,17 +222,404 @@ void perft(Board &board, std::stringstream &input_stream) {
   }
 }
 
-void accept_commands() {
-  std::cout << std::format("    v{}, written by {}\n", kEngineVersion, kEngineAuthor) << std::endl;
+struct BenchResult {
+  long long nodes = 0;
+  long long elapsed = 0;
+  SearchStats stats;
+};
+
+// searches every bench position to the bench depth
+BenchResult run_bench_searches(Board &board, std::optional<PerfCounters> &perf_counters) {
+  if (!board.initialized()) {
+    board = Board(kTranspositionTableMbSize);
+  }
+
+  TimeManagement::Config time_config{};
+  time_config.depth = kBenchDepth;
+
+  BenchResult result;
+  const auto start_time = std::chrono::steady_clock::now();
+
+  for (const auto &fen : kBenchFens) {
+    board.get_transpo_table().clear();
+    board.set_from_fen(fen);
+
+    Search search(time_config, board);
+
+    // only the searches themselves are measured, not the setup between positions
+    if (perf_counters.has_value()) perf_counters->start();
+    search.go();
+    if (perf_counters.has_value()) perf_counters->stop();
+
+    result.nodes += search.get_nodes_searched();
+    result.stats += search.get_stats();
+  }
+
+  result.elapsed = duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+  return result;
+}
+
+bool bench(Board &board, std::stringstream &input_stream) {
+  std::string option;
+  const bool profile = input_stream >> option && option == "profile";
+
+  std::optional<PerfCounters> perf_counters;
+  if (profile) {
+    perf_counters.emplace();
+  }
+
+  allocation_tracker::reset();
+
+  if (board.initialized()) {
+    board.get_eval_cache().reset_stats();
+  }
+
+  const auto result = run_bench_searches(board, perf_counters);
+  const long long total_nodes = result.nodes, elapsed = result.elapsed;
+
+  result.stats.print();
+
+  const auto &eval_cache = board.get_eval_cache();
+  std::cout << std::format("info string eval cache probes {} hits {} hit rate {:.1f}%",
+                           eval_cache.get_probes(),
+                           eval_cache.get_hits(),
+                           eval_cache.get_hits() * 100.0 / std::max<U64>(eval_cache.get_probes(), 1)) << std::endl;
+  if (perf_counters.has_value()) {
+    perf_counters->print(total_nodes);
+  }
+
+  if constexpr (allocation_tracker::kEnabled) {
+    const U64 search_allocations = allocation_tracker::allocations(allocation_tracker::Phase::kSearch);
+    std::cout << std::format("info string allocations search {} output {} other {}",
+                             search_allocations,
+                             allocation_tracker::allocations(allocation_tracker::Phase::kOutput),
+                             allocation_tracker::allocations(allocation_tracker::Phase::kOther)) << std::endl;
+
+    // the search is expected to never touch the heap
+    if (search_allocations > 0) {
+      std::cerr << std::format("bench failed: {} heap allocations during search\n", search_allocations);
+      return false;
+    }
+  }
+
+  std::cout << std::format("{} nodes {} nps", total_nodes, total_nodes * 1000 / std::max<long long>(elapsed, 1)) << std::endl;
+  return true;
+}
+
+void eval_bench(Board &board) {
+  if (!nnue::is_loaded()) {
+    std::cout << "info string no network loaded, set one with setoption name EvalFile value <path>" << std::endl;
+    return;
+  }
+
+  if (!board.initialized()) {
+    board = Board(kTranspositionTableMbSize);
+  }
+
+  const bool was_enabled = nnue::is_enabled();
+
+  for (const bool use_nnue : {false, true}) {
+    nnue::set_enabled(use_nnue);
+    const auto eval_name = use_nnue ? std::format("nnue ({})", nnue::simd_name()) : std::string("psqt");
+
+    // evaluation throughput: evaluate every position up to two plies from each bench position
+    // this includes making the moves, so the incremental accumulator updates are accounted for
+    // the eval cache is cleared first, so every evaluation is computed rather than looked up
+    board.get_eval_cache().clear();
+    long long evaluations = 0;
+    int checksum = 0;
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    for (const auto &fen : kBenchFens) {
+      board.set_from_fen(fen);
+
+      auto moves = move_gen::moves(MoveType::kAll, board);
+      for (int i = 0; i < moves.size(); i++) {
+        if (!board.is_move_legal(moves[i])) continue;
+
+        board.make_move(moves[i]);
+        checksum += eval::evaluate(board);
+        evaluations++;
+
+        auto replies = move_gen::moves(MoveType::kAll, board);
+        for (int j = 0; j < replies.size(); j++) {
+          if (!board.is_move_legal(replies[j])) continue;
+
+          board.make_move(replies[j]);
+          checksum += eval::evaluate(board);
+          evaluations++;
+          board.undo_move();
+        }
+
+        board.undo_move();
+      }
+    }
+
+    const auto eval_elapsed =
+        duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << std::format("info string evalbench {} evaluations {} evals/s {} (checksum {})",
+                             eval_name,
+                             evaluations,
+                             evaluations * 1000000 / std::max<long long>(eval_elapsed, 1),
+                             checksum) << std::endl;
+
+    board.get_eval_cache().clear();
+    std::optional<PerfCounters> no_perf_counters;
+    const auto result = run_bench_searches(board, no_perf_counters);
+    std::cout << std::format("info string evalbench {} search nodes {} nps {}",
+                             eval_name,
+                             result.nodes,
+                             result.nodes * 1000 / std::max<long long>(result.elapsed, 1)) << std::endl;
+  }
+
+  nnue::set_enabled(was_enabled);
+  board.get_eval_cache().clear();
+}
 
+// each labelling thread searches with its own small transposition table, which is kept between positions since clearing
+// it would cost more than the quiescence search itself. so a score can vary slightly with what the table already holds,
+// and a capture sequence can end early where the table already knew the score of a position
+const int kLabelTranspositionTableMbSize = 1;
+
+// positions are read, labelled in parallel and written in batches, so files of any size stream through
+const std::size_t kLabelBatchSize = 1 << 14;
+
+struct Labeller {
+  Board board;
+  TimeManagement::Config time_config;
+  Search search;
+
+  Labeller() : board(kLabelTranspositionTableMbSize), time_config(), search(time_config, board) {}
+};
+
+// labels a single fen (or epd, whose move counters are optional), returns an empty string if it can't be parsed
+std::string label_position(Labeller &labeller, const std::string &line) {
+  std::stringstream stream(line);
+  std::string placement, turn, castling, en_passant, fifty_move_clock = "0", move_number = "1";
+  if (!(stream >> placement >> turn >> castling >> en_passant)) {
+    return "";
+  }
+
+  // anything after the four fen fields that isn't a pair of move counters, such as an epd opcode, is ignored
+  if (std::string first, second; stream >> first >> second && std::isdigit(first.front()) &&
+                                 std::isdigit(second.front())) {
+    fifty_move_clock = first;
+    move_number = second;
+  }
+
+  const auto fen =
+      std::format("{} {} {} {} {} {}", placement, turn, castling, en_passant, fifty_move_clock, move_number);
+
+  auto &board = labeller.board;
+  board.set_from_fen(fen);
+
+  const auto &state = board.get_state();
+  const int static_eval = eval::evaluate(board);
+
+  PVLine capture_sequence;
+  const int quiescence_score = labeller.search.quiescence(capture_sequence);
+
+  bool capture_available = false;
+  auto captures = move_gen::moves(MoveType::kCaptures, board);
+  for (int i = 0; i < captures.size(); i++) {
+    if (board.is_move_legal(captures[i])) {
+      capture_available = true;
+      break;
+    }
+  }
+
+  return std::format("{};{};{};{};{};{}",
+                     fen,
+                     static_eval,
+                     quiescence_score,
+                     capture_sequence.to_string(),
+                     state.checkers != 0 ? 1 : 0,
+                     capture_available ? 1 : 0);
+}
+
+bool label(std::stringstream &input_stream) {
+  std::string input_path, output_path;
+  int num_threads = 0;
+  if (!(input_stream >> input_path >> output_path)) {
+    std::cerr << "usage: label <input fens> <output file> [threads]" << std::endl;
+    return false;
+  }
+
+  if (!(input_stream >> num_threads) || num_threads <= 0) {
+    num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+
+  std::ifstream input(input_path);
+  if (!input) {
+    std::cerr << std::format("could not open {}", input_path) << std::endl;
+    return false;
+  }
+
+  std::ofstream output(output_path);
+  if (!output) {
+    std::cerr << std::format("could not open {}", output_path) << std::endl;
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Labeller>> labellers;
+  for (int thread = 0; thread < num_threads; thread++) {
+    labellers.push_back(std::make_unique<Labeller>());
+  }
+
+  output << "fen;static eval;qsearch score;capture sequence;in check;capture available\n";
+
+  const auto start_time = std::chrono::steady_clock::now();
+  long long labelled = 0, skipped = 0;
+
+  std::vector<std::string> lines, labels;
+  lines.reserve(kLabelBatchSize);
+
+  while (input) {
+    lines.clear();
+    for (std::string line; lines.size() < kLabelBatchSize && std::getline(input, line);) {
+      if (!line.empty()) {
+        lines.push_back(std::move(line));
+      }
+    }
+
+    if (lines.empty()) {
+      break;
+    }
+
+    labels.assign(lines.size(), std::string());
+
+    // the threads take positions from the batch one at a time, which keeps them busy when some are slower to search
+    std::atomic<std::size_t> next_line = 0;
+    std::vector<std::thread> threads;
+    for (auto &labeller : labellers) {
+      threads.emplace_back([&, labeller = labeller.get()] {
+        for (std::size_t i = next_line++; i < lines.size(); i = next_line++) {
+          labels[i] = label_position(*labeller, lines[i]);
+        }
+      });
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    for (const auto &position_label : labels) {
+      if (position_label.empty()) {
+        skipped++;
+        continue;
+      }
+
+      output << position_label << '\n';
+      labelled++;
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << std::format("info string labelled {} positions ({} skipped) in {:.1f}s, {:.0f} positions/s",
+                             labelled,
+                             skipped,
+                             elapsed,
+                             labelled / std::max(elapsed, 1e-9)) << std::endl;
+  }
+
+  return true;
+}
+
+void set_option(Board &board, std::stringstream &input_stream) {
+  std::string token, name, value;
+
+  // option names and values may contain spaces: setoption name <name> value <value>
+  input_stream >> token;
+  while (input_stream >> token && token != "value") {
+    name += (name.empty() ? "" : " ") + token;
+  }
+  while (input_stream >> token) {
+    value += (value.empty() ? "" : " ") + token;
+  }
+
+  // cached evaluations are no longer valid once the evaluation function changes
+  if (board.initialized()) {
+    board.get_eval_cache().clear();
+  }
+
+  if (name == "EvalFile") {
+    if (nnue::load(value)) {
+      std::cout << std::format("info string loaded network {}", value) << std::endl;
+      // the accumulator of the current position is now out of date
+      if (board.initialized()) {
+        board.refresh_accumulator();
+      }
+    } else {
+      std::cout << std::format("info string failed to load network {}", value) << std::endl;
+    }
+  } else if (name == "UseNNUE") {
+    nnue::set_enabled(value == "true");
+    // the accumulators aren't updated while the nnue is disabled
+    if (board.initialized()) {
+      board.refresh_accumulator();
+    }
+  } else if (name == "MultiPV") {
+    multi_pv_lines = std::clamp(std::atoi(value.c_str()), 1, kMaxMultiPV);
+  } else {
+    std::cout << std::format("info string unknown option {}", name) << std::endl;
+  }
+}
+
+void trace(std::stringstream &input_stream) {
+  if constexpr (!tracer::kEnabled) {
+    std::cout << "info string tracing is not compiled in, configure with -DSEARCH_TRACE=ON" << std::endl;
+    return;
+  }
+
+  std::string option;
+  input_stream >> option;
+
+  if (option == "clear") {
+    tracer::clear();
+  } else if (option.empty()) {
+    tracer::dump(std::cout);
+  } else {
+    // any other argument is the file to write the trace to
+    std::ofstream file(option);
+    if (!file) {
+      std::cerr << std::format("unable to open trace file: {}\n", option);
+      return;
+    }
+
+    tracer::dump(file);
+  }
+}
+
+void initialize() {
   // init attack lookups
   move_gen::initialize_attacks();
 
+  // init the piece-square table that boards keep incrementally updated
+  eval::init_tables();
+
+  // generate the king and pawn versus king bitbase, which needs the attack tables
+  bitbase::init_kpk();
+
+  // build the cuckoo tables of reversible moves, which also need the attack tables
+  cuckoo::init_tables();
+
+  // use the network embedded at compile time, if any
+  nnue::load_embedded();
+
   // init table lookups that the search will do
   Search::init_tables();
+}
+
+void accept_commands() {
+  std::cout << std::format("    v{}, written by {}\n", kEngineVersion, kEngineAuthor) << std::endl;
 
   Board board;
 
+  // the search reads its limits from the config, which every go command overwrites
+  TimeManagement::Config time_config{};
+  Search search(time_config, board);
+  MateSearch mate_search(board, kTranspositionTableMbSize);
+
   std::string input_line;
   while (input_line != "quit") {
     std::getline(std::cin, input_line);
@@ -137,17 +631,33 @@ void accept_commands() {
     if (command == "uci") {
       std::cout << std::format("id name {}", kEngineName) << std::endl;
       std::cout << std::format("id author {}", kEngineAuthor) << std::endl;
+      std::cout << "option name EvalFile type string default <empty>" << std::endl;
+      std::cout << "option name UseNNUE type check default true" << std::endl;
+      std::cout << std::format("option name MultiPV type spin default 1 min 1 max {}", kMaxMultiPV) << std::endl;
+      std::cout << std::format("info string cpu variant {}", kCpuVariant) << std::endl;
       std::cout << "uciok" << std::endl;
     } else if (command == "isready") {
       std::cout << "readyok" << std::endl;
     } else if (command == "position") {
       position(board, input_stream);
     } else if (command == "go") {
-      go(board, input_stream);
+      go(board, search, mate_search, time_config, input_stream);
     } else if (command == "ucinewgame") {
       board.get_transpo_table().clear();
+      board.get_eval_cache().clear();
+      search.new_game();
     } else if (command == "print") {
       board.print_pieces();
+    } else if (command == "bench") {
+      bench(board, input_stream);
+    } else if (command == "setoption") {
+      set_option(board, input_stream);
+    } else if (command == "evalbench") {
+      eval_bench(board);
+    } else if (command == "label") {
+      label(input_stream);
+    } else if (command == "trace") {
+      trace(input_stream);
     }
   }
 }
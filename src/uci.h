@@ -3,6 +3,7 @@
 
 #include "board.h"
 #include "fen.h"
+#include "mate_search.h"
 #include "search.h"
 
 namespace uci {
@@ -12,12 +13,42 @@ const std::string kEngineVersion = "0.1";
 const std::string kEngineAuthor = "Aron Petkovski";
 const std::string kEngineDescription = "Aron Petkovski";
 
+// the instruction set level this copy of the engine was compiled for
+#ifdef CPU_VARIANT
+const std::string kCpuVariant = CPU_VARIANT;
+#else
+const std::string kCpuVariant = "native";
+#endif
+
 void position(Board &board, std::stringstream &input_stream);
 
-void go(Board &board, std::stringstream &input_stream);
+// the searches are kept between go commands, so they can build on what they learned searching the game's earlier
+// positions
+void go(Board &board,
+        Search &search,
+        MateSearch &mate_search,
+        TimeManagement::Config &time_config,
+        std::stringstream &input_stream);
 
 void perft(Board &board, std::stringstream &input_stream);
 
+// returns false if the bench detected a problem with the search (e.g. allocations in an allocation tracking build)
+bool bench(Board &board, std::stringstream &input_stream);
+
+// compares the evaluation throughput and search speed of the hand-crafted evaluation and the nnue
+void eval_bench(Board &board);
+
+// writes the static evaluation, quiescence search score and capture sequence, and whether the side to move is in check
+// or has a capture, of every fen in a file, labelling them in parallel and reporting the throughput
+// returns false if the files couldn't be opened
+bool label(std::stringstream &input_stream);
+
+void set_option(Board &board, std::stringstream &input_stream);
+
+void trace(std::stringstream &input_stream);
+
+void initialize();
+
 void accept_commands();
 
 }
@@ -7,12 +7,7 @@ U64 hash_turn(Color turn) {
   return turn == Color::kWhite ? kRandomsArray[Indices::kTurn] : 0ULL;
 }
 
-U64 hash_square(Square square, const BoardState &state, Color color, PieceType piece) {
-  if (color == Color::kNoColor || piece == PieceType::kNone) {
-    color = state.get_piece_color(square);
-    piece = state.get_piece_type(square);
-  }
-
+U64 hash_piece(Square square, Color color, PieceType piece) {
   /*
    * http://hgm.nubati.net/book_format.html
    * black pawn    0
@@ -34,6 +29,15 @@ U64 hash_square(Square square, const BoardState &state, Color color, PieceType p
   return kRandomsArray[piece_idx];
 }
 
+U64 hash_square(Square square, const BoardState &state, Color color, PieceType piece) {
+  if (color == Color::kNoColor || piece == PieceType::kNone) {
+    color = state.get_piece_color(square);
+    piece = state.get_piece_type(square);
+  }
+
+  return hash_piece(square, color, piece);
+}
+
 U64 hash_castle_rights(const CastleRights &rights) {
   U64 hash = 0;
   if (rights.can_kingside_castle(Color::kWhite)) hash ^= kRandomsArray[Indices::kWhiteKingside];
@@ -69,4 +73,15 @@ U64 generate_key(const BoardState &state) {
   return pieces ^ hash_castle_rights(state.castle_rights) ^ hash_en_passant(state) ^ hash_turn(state.turn);
 }
 
+U64 generate_pawn_key(const BoardState &state) {
+  U64 key = 0;
+
+  BitBoard pawns = state.pawns();
+  while (pawns) {
+    key ^= hash_square(Square(pawns.pop_lsb()), state);
+  }
+
+  return key;
+}
+
 }
\ No newline at end of file
@@ -222,6 +222,9 @@ enum Indices : int {
 
 U64 hash_turn(Color turn);
 
+// key of a piece on a square, independent of any board
+U64 hash_piece(Square square, Color color, PieceType piece);
+
 U64 hash_square(Square square, const BoardState &state, Color color = Color::kNoColor, PieceType piece = PieceType::kNone);
 
 U64 hash_castle_rights(const CastleRights &rights);
@@ -230,6 +233,9 @@ U64 hash_en_passant(const BoardState &state);
 
 U64 generate_key(const BoardState &state);
 
+// key of only the pawns on the board, used to index the pawn hash table
+U64 generate_pawn_key(const BoardState &state);
+
 }
 
 #endif // INTEGRAL_ZOBRIST_H_
\ No newline at end of file
@@ -0,0 +1,176 @@
+// runs "bench" on two integral binaries in an interleaved fashion and compares their nps statistically
+// usage: bench_compare <base binary> <test binary> [runs]
+//
+// each run pairs one base bench with one test bench back-to-back, so that slow drifts in machine load affect both sides
+// roughly equally. the per-pair nps differences give a mean and a 95% confidence interval, and the node counts (the
+// bench signature) are compared to flag functional changes
+//
+// exits with 2 on a significant slowdown, 3 if the node signature changed, and 0 otherwise
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+  long long nodes;
+  long long nps;
+};
+
+// two-sided 95% critical values of student's t distribution for 1 to 30 degrees of freedom
+const std::array<double, 30> kStudentT975 = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+double critical_value(int degrees_of_freedom) {
+  if (degrees_of_freedom <= 0) {
+    return 0.0;
+  }
+  return degrees_of_freedom <= static_cast<int>(kStudentT975.size()) ? kStudentT975[degrees_of_freedom - 1] : 1.96;
+}
+
+// runs the bench of a binary and parses its last line, which reads "<nodes> nodes <nps> nps"
+std::optional<BenchResult> run_bench(const std::string &binary) {
+  const std::string command = std::format("\"{}\" bench", binary);
+
+  FILE *pipe = popen(command.c_str(), "r");
+  if (!pipe) {
+    return std::nullopt;
+  }
+
+  std::string last_line, line;
+  std::array<char, 4096> buffer{};
+  while (fgets(buffer.data(), buffer.size(), pipe)) {
+    line += buffer.data();
+    if (!line.empty() && line.back() == '\n') {
+      last_line = line;
+      line.clear();
+    }
+  }
+  if (!line.empty()) {
+    last_line = line;
+  }
+
+  if (pclose(pipe) != 0) {
+    return std::nullopt;
+  }
+
+  std::stringstream stream(last_line);
+
+  BenchResult result{};
+  std::string nodes_label, nps_label;
+  if (!(stream >> result.nodes >> nodes_label >> result.nps >> nps_label) || nodes_label != "nodes" ||
+      nps_label != "nps") {
+    return std::nullopt;
+  }
+
+  return result;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: bench_compare <base binary> <test binary> [runs]" << std::endl;
+    return 1;
+  }
+
+  const std::string base_binary = argv[1];
+  const std::string test_binary = argv[2];
+  const int runs = argc > 3 ? std::max(2, std::stoi(argv[3])) : 10;
+
+  std::vector<BenchResult> base_results, test_results;
+
+  for (int run = 0; run < runs; run++) {
+    // alternate which binary goes first, so neither always gets the warmer (or cooler) machine
+    const bool base_first = run % 2 == 0;
+
+    std::optional<BenchResult> base, test;
+    if (base_first) {
+      base = run_bench(base_binary);
+      test = run_bench(test_binary);
+    } else {
+      test = run_bench(test_binary);
+      base = run_bench(base_binary);
+    }
+
+    if (!base.has_value() || !test.has_value()) {
+      std::cerr << std::format("failed to run bench on {}\n", !base.has_value() ? base_binary : test_binary);
+      return 1;
+    }
+
+    base_results.push_back(*base);
+    test_results.push_back(*test);
+
+    std::cout << std::format("run {:>3}: base {:>10} nps, test {:>10} nps ({:+.2f}%)",
+                             run + 1,
+                             base->nps,
+                             test->nps,
+                             100.0 * (test->nps - base->nps) / base->nps) << std::endl;
+  }
+
+  // paired differences in nps, relative to the base
+  std::vector<double> differences;
+  double base_mean = 0.0, test_mean = 0.0;
+  for (int run = 0; run < runs; run++) {
+    differences.push_back(static_cast<double>(test_results[run].nps - base_results[run].nps));
+    base_mean += static_cast<double>(base_results[run].nps) / runs;
+    test_mean += static_cast<double>(test_results[run].nps) / runs;
+  }
+
+  double mean_difference = 0.0;
+  for (const double difference : differences) {
+    mean_difference += difference / runs;
+  }
+
+  double variance = 0.0;
+  for (const double difference : differences) {
+    variance += (difference - mean_difference) * (difference - mean_difference) / (runs - 1);
+  }
+
+  const double margin = critical_value(runs - 1) * std::sqrt(variance / runs);
+  const double lower = mean_difference - margin, upper = mean_difference + margin;
+
+  std::cout << std::endl;
+  std::cout << std::format("base mean: {:.0f} nps", base_mean) << std::endl;
+  std::cout << std::format("test mean: {:.0f} nps", test_mean) << std::endl;
+  std::cout << std::format("difference: {:+.0f} nps ({:+.2f}%), 95% ci [{:+.2f}%, {:+.2f}%]",
+                           mean_difference,
+                           100.0 * mean_difference / base_mean,
+                           100.0 * lower / base_mean,
+                           100.0 * upper / base_mean) << std::endl;
+
+  // the node count of bench is deterministic, so any change means the search itself behaves differently
+  bool signature_changed = false;
+  for (int run = 0; run < runs; run++) {
+    if (base_results[run].nodes != base_results.front().nodes || test_results[run].nodes != test_results.front().nodes) {
+      std::cout << "warning: node counts differ between runs of the same binary, the bench is not deterministic"
+                << std::endl;
+      break;
+    }
+  }
+
+  if (base_results.front().nodes != test_results.front().nodes) {
+    signature_changed = true;
+    std::cout << std::format("node signature changed: {} -> {}", base_results.front().nodes, test_results.front().nodes)
+              << std::endl;
+  } else {
+    std::cout << std::format("node signature unchanged: {}", base_results.front().nodes) << std::endl;
+  }
+
+  if (upper < 0.0) {
+    std::cout << "result: significant slowdown" << std::endl;
+    return 2;
+  } else if (lower > 0.0) {
+    std::cout << "result: significant speedup" << std::endl;
+  } else {
+    std::cout << "result: no significant difference" << std::endl;
+  }
+
+  return signature_changed ? 3 : 0;
+}
\ No newline at end of file
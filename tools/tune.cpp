@@ -0,0 +1,464 @@
+// tunes the hand-crafted evaluation weights with texel's method on a set of positions labelled with game results
+// usage: tune <positions.epd> <output header> [epochs] [threads]
+//
+// each line holds a fen followed by the result of the game it was taken from, from white's point of view, either as
+// [1.0] / [0.5] / [0.0] or as "1-0" / "1/2-1/2" / "0-1". every position is evaluated once with a trace that records how
+// often each weight was applied for each side, which makes the evaluation a linear function of the weights:
+//
+//   eval = (mg * phase + eg * scale / 64 * (24 - phase)) / 24 + tempo
+//
+// where mg and eg are sums of trace coefficient times weight. the scaling constant of the sigmoid is fitted to the
+// current weights first, then the mean squared error between sigmoid(eval) and the results is minimised with adam
+// using full-batch gradients. positions that the hand-crafted evaluation doesn't score (insufficient material, known
+// endgames with a specialised evaluator) are skipped
+//
+// the weights are written to the output header in the format of src/eval_weights.h, running zero epochs reproduces
+// the current weights
+
+#include "../src/bitbase.h"
+#include "../src/board.h"
+#include "../src/eval.h"
+#include "../src/eval_trace.h"
+#include "../src/eval_weights.h"
+#include "../src/move_gen.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// layout of the weight vector, in the order the weights are written to the header
+const int kPieceValueIndex = 0;
+const int kPieceSquareIndex = kPieceValueIndex + PieceType::kNumTypes;
+const int kPassedPawnIndex = kPieceSquareIndex + PieceType::kNumTypes * static_cast<int>(Square::kSquareCount);
+const int kIsolatedPawnIndex = kPassedPawnIndex + kNumRanks;
+const int kDoubledPawnIndex = kIsolatedPawnIndex + 1;
+const int kBackwardPawnIndex = kDoubledPawnIndex + 1;
+const int kBishopPairIndex = kBackwardPawnIndex + 1;
+const int kNumWeights = kBishopPairIndex + 1;
+
+struct Weight {
+  double mg = 0.0;
+  double eg = 0.0;
+};
+
+// the white minus black count of a weight in a position
+struct Coefficient {
+  std::uint16_t index;
+  std::int16_t value;
+};
+
+struct Position {
+  // range of this position's coefficients in the shared coefficient list
+  std::size_t begin, end;
+  double result;
+  std::uint8_t phase;
+  std::uint8_t scale;
+  std::int8_t tempo;
+};
+
+struct Dataset {
+  std::vector<Position> positions;
+  std::vector<Coefficient> coefficients;
+};
+
+std::vector<Weight> current_weights() {
+  std::vector<Weight> weights(kNumWeights);
+
+  const auto set = [&](int index, eval::PackedScore score) {
+    weights[index] = {static_cast<double>(score.middle_game()), static_cast<double>(score.end_game())};
+  };
+
+  for (int piece = 0; piece < PieceType::kNumTypes; piece++) {
+    set(kPieceValueIndex + piece, eval::kPieceValues[piece]);
+    for (int square = 0; square < Square::kSquareCount; square++) {
+      set(kPieceSquareIndex + piece * Square::kSquareCount + square, eval::kPieceSquareTable[piece][square]);
+    }
+  }
+
+  for (int rank = 0; rank < kNumRanks; rank++) {
+    set(kPassedPawnIndex + rank, eval::kPassedPawnBonus[rank]);
+  }
+
+  set(kIsolatedPawnIndex, eval::kIsolatedPawnPenalty);
+  set(kDoubledPawnIndex, eval::kDoubledPawnPenalty);
+  set(kBackwardPawnIndex, eval::kBackwardPawnPenalty);
+  set(kBishopPairIndex, eval::kBishopPairBonus);
+
+  return weights;
+}
+
+void add_coefficients(const eval::Trace &trace, std::vector<Coefficient> &coefficients) {
+  const auto add = [&](int index, const std::array<int, 2> &counts) {
+    const int value = counts[Color::kWhite] - counts[Color::kBlack];
+    if (value != 0) {
+      coefficients.push_back({static_cast<std::uint16_t>(index), static_cast<std::int16_t>(value)});
+    }
+  };
+
+  for (int piece = 0; piece < PieceType::kNumTypes; piece++) {
+    add(kPieceValueIndex + piece, trace.piece_values[piece]);
+    for (int square = 0; square < Square::kSquareCount; square++) {
+      add(kPieceSquareIndex + piece * Square::kSquareCount + square, trace.piece_squares[piece][square]);
+    }
+  }
+
+  for (int rank = 0; rank < kNumRanks; rank++) {
+    add(kPassedPawnIndex + rank, trace.passed_pawns[rank]);
+  }
+
+  add(kIsolatedPawnIndex, trace.isolated_pawns);
+  add(kDoubledPawnIndex, trace.doubled_pawns);
+  add(kBackwardPawnIndex, trace.backward_pawns);
+  add(kBishopPairIndex, trace.bishop_pairs);
+}
+
+// parses the game result of an epd line, returns a negative value if there is none
+double parse_result(const std::string &line) {
+  if (line.find("[1.0]") != std::string::npos || line.find("\"1-0\"") != std::string::npos) return 1.0;
+  if (line.find("[0.5]") != std::string::npos || line.find("\"1/2-1/2\"") != std::string::npos) return 0.5;
+  if (line.find("[0.0]") != std::string::npos || line.find("\"0-1\"") != std::string::npos) return 0.0;
+  return -1.0;
+}
+
+// evaluates each labelled line with a trace, returns the white relative engine evaluations alongside for verification
+Dataset load_positions(const std::vector<std::string> &lines, std::vector<int> &evaluations) {
+  Dataset dataset;
+  Board board;
+
+  for (const auto &line : lines) {
+    const double result = parse_result(line);
+    if (result < 0.0) {
+      continue;
+    }
+
+    // only the first four fields are needed, the move counters don't affect the evaluation
+    std::stringstream stream(line);
+    std::string placement, turn, castling, en_passant;
+    if (!(stream >> placement >> turn >> castling >> en_passant)) {
+      continue;
+    }
+
+    board.set_from_fen(std::format("{} {} {} {} 0 1", placement, turn, castling, en_passant));
+
+    eval::Trace trace{};
+    eval::current_trace = &trace;
+    const int evaluation = eval::evaluate(board);
+    eval::current_trace = nullptr;
+
+    if (!trace.hand_crafted) {
+      continue;
+    }
+
+    const auto side = board.get_state().turn;
+
+    Position position{};
+    position.begin = dataset.coefficients.size();
+    add_coefficients(trace, dataset.coefficients);
+    position.end = dataset.coefficients.size();
+    position.result = result;
+    position.phase = static_cast<std::uint8_t>(trace.phase);
+    position.scale = static_cast<std::uint8_t>(trace.scale);
+    position.tempo = side == Color::kWhite ? 1 : -1;
+
+    dataset.positions.push_back(position);
+    evaluations.push_back(side == Color::kWhite ? evaluation : -evaluation);
+  }
+
+  return dataset;
+}
+
+// white relative evaluation of a position under the linear model
+double linear_eval(const Position &position, const Dataset &dataset, const std::vector<Weight> &weights) {
+  double mg = 0.0, eg = 0.0;
+  for (std::size_t i = position.begin; i < position.end; i++) {
+    const auto &coefficient = dataset.coefficients[i];
+    mg += coefficient.value * weights[coefficient.index].mg;
+    eg += coefficient.value * weights[coefficient.index].eg;
+  }
+
+  const double eg_scale = position.scale / static_cast<double>(eval::kScaleNormal);
+  return (mg * position.phase + eg * eg_scale * (eval::kMaxGamePhase - position.phase)) / eval::kMaxGamePhase +
+         eval::kTempoBonus * position.tempo;
+}
+
+double sigmoid(double k, double evaluation) {
+  return 1.0 / (1.0 + std::pow(10.0, -k * evaluation / 400.0));
+}
+
+// runs fn(thread index, first, last) over the positions split evenly between the threads
+template <typename Function>
+void parallel_for(std::size_t count, int num_threads, Function fn) {
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < num_threads; thread++) {
+    const std::size_t first = count * thread / num_threads;
+    const std::size_t last = count * (thread + 1) / num_threads;
+    threads.emplace_back(fn, thread, first, last);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+double mean_error(double k, const Dataset &dataset, const std::vector<Weight> &weights, int num_threads) {
+  std::vector<double> errors(num_threads);
+  parallel_for(dataset.positions.size(), num_threads, [&](int thread, std::size_t first, std::size_t last) {
+    double error = 0.0;
+    for (std::size_t i = first; i < last; i++) {
+      const auto &position = dataset.positions[i];
+      const double difference = sigmoid(k, linear_eval(position, dataset, weights)) - position.result;
+      error += difference * difference;
+    }
+    errors[thread] = error;
+  });
+
+  double total = 0.0;
+  for (const double error : errors) total += error;
+  return total / dataset.positions.size();
+}
+
+// narrows down the sigmoid scaling constant with the smallest error by scanning in increasingly finer steps
+double fit_k(const Dataset &dataset, const std::vector<Weight> &weights, int num_threads) {
+  double best_k = 1.0, best_error = mean_error(best_k, dataset, weights, num_threads);
+  double step = 0.5;
+
+  for (int iteration = 0; iteration < 6; iteration++) {
+    const double center = best_k;
+    for (int offset = -5; offset <= 5; offset++) {
+      const double k = center + offset * step;
+      if (k <= 0.0) {
+        continue;
+      }
+
+      const double error = mean_error(k, dataset, weights, num_threads);
+      if (error < best_error) {
+        best_error = error;
+        best_k = k;
+      }
+    }
+    step /= 5.0;
+  }
+
+  return best_k;
+}
+
+std::vector<Weight> compute_gradient(double k,
+                                     const Dataset &dataset,
+                                     const std::vector<Weight> &weights,
+                                     int num_threads) {
+  std::vector<std::vector<Weight>> thread_gradients(num_threads, std::vector<Weight>(kNumWeights));
+
+  parallel_for(dataset.positions.size(), num_threads, [&](int thread, std::size_t first, std::size_t last) {
+    auto &gradient = thread_gradients[thread];
+    for (std::size_t i = first; i < last; i++) {
+      const auto &position = dataset.positions[i];
+
+      // derivative of the squared error with respect to the evaluation
+      const double prediction = sigmoid(k, linear_eval(position, dataset, weights));
+      const double error_gradient =
+          2.0 * (prediction - position.result) * prediction * (1.0 - prediction) * k * std::log(10.0) / 400.0;
+
+      const double mg_factor = error_gradient * position.phase / eval::kMaxGamePhase;
+      const double eg_factor = error_gradient * (eval::kMaxGamePhase - position.phase) / eval::kMaxGamePhase * position.scale /
+                               eval::kScaleNormal;
+
+      for (std::size_t j = position.begin; j < position.end; j++) {
+        const auto &coefficient = dataset.coefficients[j];
+        gradient[coefficient.index].mg += coefficient.value * mg_factor;
+        gradient[coefficient.index].eg += coefficient.value * eg_factor;
+      }
+    }
+  });
+
+  std::vector<Weight> gradient(kNumWeights);
+  for (const auto &thread_gradient : thread_gradients) {
+    for (int i = 0; i < kNumWeights; i++) {
+      gradient[i].mg += thread_gradient[i].mg / dataset.positions.size();
+      gradient[i].eg += thread_gradient[i].eg / dataset.positions.size();
+    }
+  }
+
+  return gradient;
+}
+
+std::string format_score(const Weight &weight) {
+  return std::format("PackedScore({}, {})", std::lround(weight.mg), std::lround(weight.eg));
+}
+
+// writes the weights in the layout of src/eval_weights.h
+void write_header(const std::string &path, const std::vector<Weight> &weights) {
+  const std::array<const char *, PieceType::kNumTypes> piece_names = {
+      "pawns", "knights", "bishops", "rooks", "queens", "king"};
+
+  std::ofstream file(path);
+
+  file << "#ifndef INTEGRAL_EVAL_WEIGHTS_H_\n";
+  file << "#define INTEGRAL_EVAL_WEIGHTS_H_\n\n";
+  file << "#include \"psqt.h\"\n\n";
+  file << "// evaluation weights, written by the tune tool (tools/tune.cpp)\n";
+  file << "// the piece-square tables are laid out as seen from white's side of the board, starting with a8\n";
+  file << "namespace eval {\n\n";
+  file << "// clang-format off\n";
+
+  file << "const std::array<PackedScore, PieceType::kNumTypes> kPieceValues = {\n    ";
+  for (int piece = 0; piece < PieceType::kNumTypes; piece++) {
+    file << (piece > 0 ? ", " : "") << format_score(weights[kPieceValueIndex + piece]);
+  }
+  file << "\n};\n\n";
+
+  file << "const std::array<std::array<PackedScore, Square::kSquareCount>, PieceType::kNumTypes> kPieceSquareTable "
+          "= {{\n";
+  for (int piece = 0; piece < PieceType::kNumTypes; piece++) {
+    file << "    // " << piece_names[piece] << "\n    {\n";
+    for (int square = 0; square < Square::kSquareCount; square++) {
+      file << (square % 4 == 0 ? "        " : " ")
+           << format_score(weights[kPieceSquareIndex + piece * Square::kSquareCount + square]) << ","
+           << (square % 4 == 3 ? "\n" : "");
+    }
+    file << "    },\n";
+  }
+  file << "}};\n\n";
+
+  file << "const std::array<PackedScore, kNumRanks> kPassedPawnBonus = {\n";
+  for (int rank = 0; rank < kNumRanks; rank++) {
+    file << (rank % 4 == 0 ? "    " : " ") << format_score(weights[kPassedPawnIndex + rank])
+         << (rank == kNumRanks - 1 ? "\n" : rank % 4 == 3 ? ",\n" : ",");
+  }
+  file << "};\n\n";
+
+  const auto write_scalar = [&](const char *name, const Weight &weight) {
+    file << std::format("const PackedScore {}({}, {});\n", name, std::lround(weight.mg), std::lround(weight.eg));
+  };
+  write_scalar("kIsolatedPawnPenalty", weights[kIsolatedPawnIndex]);
+  write_scalar("kDoubledPawnPenalty", weights[kDoubledPawnIndex]);
+  write_scalar("kBackwardPawnPenalty", weights[kBackwardPawnIndex]);
+  write_scalar("kBishopPairBonus", weights[kBishopPairIndex]);
+  // the tempo bonus isn't tuned, but it lives in the same header so it's carried over
+  file << std::format("const int kTempoBonus = {};\n", eval::kTempoBonus);
+
+  file << "// clang-format on\n\n";
+  file << "}\n\n";
+  file << "#endif // INTEGRAL_EVAL_WEIGHTS_H_\n";
+}
+
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "usage: tune <positions.epd> <output header> [epochs] [threads]" << std::endl;
+    return 1;
+  }
+
+  const std::string positions_path = argv[1], output_path = argv[2];
+  const int epochs = argc > 3 ? std::max(0, std::stoi(argv[3])) : 1000;
+  const int num_threads = argc > 4 ? std::max(1, std::stoi(argv[4]))
+                                   : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  move_gen::initialize_attacks();
+  eval::init_tables();
+  bitbase::init_kpk();
+
+  std::ifstream file(positions_path);
+  if (!file) {
+    std::cerr << std::format("could not open {}", positions_path) << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  // each thread traces its share of the lines, the datasets are concatenated afterward
+  std::vector<Dataset> thread_datasets(num_threads);
+  std::vector<std::vector<int>> thread_evaluations(num_threads);
+  parallel_for(lines.size(), num_threads, [&](int thread, std::size_t first, std::size_t last) {
+    const std::vector<std::string> chunk(lines.begin() + first, lines.begin() + last);
+    thread_datasets[thread] = load_positions(chunk, thread_evaluations[thread]);
+  });
+
+  Dataset dataset;
+  std::vector<int> evaluations;
+  for (int thread = 0; thread < num_threads; thread++) {
+    const std::size_t offset = dataset.coefficients.size();
+    for (auto position : thread_datasets[thread].positions) {
+      position.begin += offset;
+      position.end += offset;
+      dataset.positions.push_back(position);
+    }
+    dataset.coefficients.insert(dataset.coefficients.end(),
+                                thread_datasets[thread].coefficients.begin(),
+                                thread_datasets[thread].coefficients.end());
+    evaluations.insert(evaluations.end(), thread_evaluations[thread].begin(), thread_evaluations[thread].end());
+  }
+
+  if (dataset.positions.empty()) {
+    std::cerr << "no labelled positions found" << std::endl;
+    return 1;
+  }
+
+  const auto load_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  std::cout << std::format("loaded {} of {} lines in {:.1f}s, {} coefficients",
+                           dataset.positions.size(),
+                           lines.size(),
+                           load_time,
+                           dataset.coefficients.size())
+            << std::endl;
+
+  auto weights = current_weights();
+
+  // the linear model only differs from the engine's evaluation by integer rounding
+  double max_deviation = 0.0;
+  for (std::size_t i = 0; i < dataset.positions.size(); i++) {
+    max_deviation =
+        std::max(max_deviation, std::abs(linear_eval(dataset.positions[i], dataset, weights) - evaluations[i]));
+  }
+  std::cout << std::format("max deviation of the linear model from the evaluation: {:.2f}", max_deviation)
+            << std::endl;
+
+  const double k = fit_k(dataset, weights, num_threads);
+  std::cout << std::format("fitted k {:.4f}, error {:.6f}", k, mean_error(k, dataset, weights, num_threads))
+            << std::endl;
+
+  const double kLearningRate = 1.0, kBeta1 = 0.9, kBeta2 = 0.999, kEpsilon = 1e-8;
+  std::vector<Weight> momentum(kNumWeights), velocity(kNumWeights);
+
+  for (int epoch = 1; epoch <= epochs; epoch++) {
+    const auto gradient = compute_gradient(k, dataset, weights, num_threads);
+
+    const double bias1 = 1.0 - std::pow(kBeta1, epoch), bias2 = 1.0 - std::pow(kBeta2, epoch);
+    const auto step = [&](double &weight, double &m, double &v, double g) {
+      m = kBeta1 * m + (1.0 - kBeta1) * g;
+      v = kBeta2 * v + (1.0 - kBeta2) * g * g;
+      weight -= kLearningRate * (m / bias1) / (std::sqrt(v / bias2) + kEpsilon);
+    };
+
+    for (int i = 0; i < kNumWeights; i++) {
+      step(weights[i].mg, momentum[i].mg, velocity[i].mg, gradient[i].mg);
+      step(weights[i].eg, momentum[i].eg, velocity[i].eg, gradient[i].eg);
+    }
+
+    if (epoch % 50 == 0 || epoch == epochs) {
+      std::cout << std::format("epoch {} error {:.6f}", epoch, mean_error(k, dataset, weights, num_threads))
+                << std::endl;
+      write_header(output_path, weights);
+    }
+  }
+
+  write_header(output_path, weights);
+  std::cout << std::format("wrote {}", output_path) << std::endl;
+
+  return 0;
+}